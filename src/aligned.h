@@ -0,0 +1,56 @@
+#ifndef __ALIGNED__
+#define __ALIGNED__
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/*
+ * Cache line aligned allocation.
+ * Everything a GameBoy writes while running (registers, IO, RAM...)
+ * starts and ends on its own cache lines, so instances running on
+ * different threads never write to the same line (no false sharing).
+ */
+const size_t CACHE_LINE_SIZE = 64;
+
+// Size is rounded up to whole cache lines
+inline void* AlignedAlloc(size_t size)
+{
+	size = (size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+	
+#ifdef _WIN32
+	void* ptr = _aligned_malloc(size, CACHE_LINE_SIZE);
+#else
+	void* ptr = NULL;
+	if (posix_memalign(&ptr, CACHE_LINE_SIZE, size) != 0)
+		ptr = NULL;
+#endif
+	
+	if (!ptr)
+		throw std::bad_alloc();
+	
+	return ptr;
+}
+
+inline void AlignedFree(void* ptr)
+{
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+// Classes deriving from this are allocated on their own cache lines
+class CacheAligned
+{
+	public:
+		static void* operator new(size_t size) { return AlignedAlloc(size); }
+		static void operator delete(void* ptr) { AlignedFree(ptr); }
+};
+
+#endif
\ No newline at end of file
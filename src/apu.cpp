@@ -0,0 +1,639 @@
+#include "apu.h"
+#include "memory.h"
+#include <string.h>
+
+// Frame sequencer runs at 512 Hz (8192 clocks), clocking length at
+// steps 0, 2, 4, 6, sweep at 2 and 6, envelope at 7
+const int SEQUENCER_CLOCKS = 8192;
+
+// Clocks of a frame (4194304 Hz), even in double speed mode
+const double CLOCK_RATE = 4194304;
+
+// Frames longer than this (no RunFrame, LCD off) are handed over in parts
+const uint64_t MAX_FRAME_CLOCKS = 131072;
+
+// Level of one step of one channel at full volume
+// (4 channels * 15 * 8 * 64 = 30720)
+const int OUTPUT_UNIT = 64;
+
+const int CHANNEL_SQUARE1 = 0;
+const int CHANNEL_SQUARE2 = 1;
+const int CHANNEL_WAVE = 2;
+const int CHANNEL_NOISE = 3;
+
+const uint8_t NR52_POWER = 0x80;
+const uint8_t NRX4_TRIGGER = 0x80;
+const uint8_t NRX4_LENGTH_ENABLE = 0x40;
+
+// Bits that always read as 1 (FF10-FF2F)
+const uint8_t READ_MASKS[0x20] =
+{
+	0x80, 0x3F, 0x00, 0xFF, 0xBF,
+	0xFF, 0x3F, 0x00, 0xFF, 0xBF,
+	0x7F, 0xFF, 0x9F, 0xFF, 0xBF,
+	0xFF, 0xFF, 0x00, 0x00, 0xBF,
+	0x00, 0x00, 0x70,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+const uint8_t DUTY[4][8] =
+{
+	{ 0, 0, 0, 0, 0, 0, 0, 1 }, // 12.5%
+	{ 1, 0, 0, 0, 0, 0, 0, 1 }, // 25%
+	{ 1, 0, 0, 0, 0, 1, 1, 1 }, // 50%
+	{ 0, 1, 1, 1, 1, 1, 1, 0 }  // 75%
+};
+
+const int NOISE_DIVISORS[8] = { 8, 16, 32, 48, 64, 80, 96, 112 };
+
+APU::APU(Memory* memory, CPU* cpu)
+{
+	this->memory = memory;
+	this->cpu = cpu;
+	
+	sink = NULL;
+	mutedSink = NULL;
+	muted = false;
+	samples = new int16_t[BlipBuffer::MAX_SAMPLES * 2];
+	
+	memory->apu = this;
+	io = memory->io;
+	
+	memset(channels, 0, sizeof(channels));
+	time = 0;
+	sequencerTime = SEQUENCER_CLOCKS;
+	sequencerStep = 0;
+	frameStart = 0;
+	memset(output, 0, sizeof(output));
+	
+	buffers[0].SetRates(CLOCK_RATE, 48000);
+	buffers[1].SetRates(CLOCK_RATE, 48000);
+}
+
+APU::~APU()
+{
+	delete[] samples;
+}
+
+void APU::Reset()
+{
+	memset(channels, 0, sizeof(channels));
+	
+	// The boot ROM's chime leaves the first channel on (at volume 0)
+	channels[CHANNEL_SQUARE1].enabled = true;
+	channels[CHANNEL_NOISE].lfsr = 0x7FFF;
+	
+	time = cpu->cycleCount;
+	sequencerTime = time + SEQUENCER_CLOCKS;
+	sequencerStep = 0;
+	
+	frameStart = time;
+	memset(output, 0, sizeof(output));
+	buffers[0].Clear();
+	buffers[1].Clear();
+}
+
+void APU::SaveState(State* state)
+{
+	CatchUp();
+	
+	memcpy(state->channels, channels, sizeof(channels));
+	state->time = time;
+	state->sequencerTime = sequencerTime;
+	state->sequencerStep = sequencerStep;
+}
+
+void APU::LoadState(const State* state)
+{
+	memcpy(channels, state->channels, sizeof(channels));
+	time = state->time;
+	sequencerTime = state->sequencerTime;
+	sequencerStep = state->sequencerStep;
+	
+	// The buffers carry on from where they were (no click), stepping
+	// to the loaded levels
+	frameStart = time;
+	UpdateOutputs();
+}
+
+void APU::SetSink(AudioSink* sink, int sampleRate)
+{
+	this->sink = sink;
+	muted = false;
+	
+	buffers[0].SetRates(CLOCK_RATE, sampleRate);
+	buffers[1].SetRates(CLOCK_RATE, sampleRate);
+	
+	frameStart = time;
+	memset(output, 0, sizeof(output));
+	buffers[0].Clear();
+	buffers[1].Clear();
+	UpdateOutputs();
+}
+
+void APU::SetSampleRate(double sampleRate)
+{
+	buffers[0].SetRates(CLOCK_RATE, sampleRate);
+	buffers[1].SetRates(CLOCK_RATE, sampleRate);
+}
+
+void APU::SetMuted(bool muted)
+{
+	if (muted == this->muted)
+		return;
+	
+	CatchUp();
+	this->muted = muted;
+	
+	if (muted)
+	{
+		mutedSink = sink;
+		sink = NULL;
+	}
+	else
+	{
+		sink = mutedSink;
+		frameStart = time;
+		UpdateOutputs();
+	}
+}
+
+uint8_t* APU::GetRegisters(int channel)
+{
+	return &io[0x10 + channel * 5];
+}
+
+int APU::GetFrequency(int channel)
+{
+	uint8_t* nr = GetRegisters(channel);
+	return ((nr[4] & 0x07) << 8) | nr[3];
+}
+
+int APU::GetPeriod(int channel)
+{
+	switch (channel)
+	{
+		case CHANNEL_SQUARE1:
+		case CHANNEL_SQUARE2:
+			return (2048 - GetFrequency(channel)) * 4;
+		
+		case CHANNEL_WAVE:
+			return (2048 - GetFrequency(channel)) * 2;
+		
+		default:
+		{
+			uint8_t nr43 = io[0x22];
+			int shift = nr43 >> 4;
+			
+			// Shifts 14 and 15 stop the LFSR
+			if (shift >= 14)
+				return 0;
+			
+			return NOISE_DIVISORS[nr43 & 0x07] << shift;
+		}
+	}
+}
+
+bool APU::IsDACEnabled(int channel)
+{
+	// Wave has a switch, the others are off with volume 0 going down
+	if (channel == CHANNEL_WAVE)
+		return (io[0x1A] & 0x80) != 0;
+	
+	return (GetRegisters(channel)[2] & 0xF8) != 0;
+}
+
+int APU::GetAmplitude(int channel)
+{
+	Channel& c = channels[channel];
+	
+	if (!c.enabled)
+		return 0;
+	
+	switch (channel)
+	{
+		case CHANNEL_SQUARE1:
+		case CHANNEL_SQUARE2:
+			return (DUTY[GetRegisters(channel)[1] >> 6][c.position])? c.volume : 0;
+		
+		case CHANNEL_WAVE:
+		{
+			// 0 = mute, 1 = 100%, 2 = 50%, 3 = 25%
+			int code = (io[0x1C] >> 5) & 0x03;
+			
+			if (!code)
+				return 0;
+			
+			uint8_t data = io[0x30 + (c.position >> 1)];
+			int sample = (c.position & 1)? (data & 0x0F) : (data >> 4);
+			return sample >> (code - 1);
+		}
+		
+		default:
+			return (c.lfsr & 1)? 0 : c.volume;
+	}
+}
+
+bool APU::IsSilent(int channel)
+{
+	// Not on either side
+	if (!(io[0x25] & (0x11 << channel)))
+		return true;
+	
+	if (channel == CHANNEL_WAVE)
+		return !(io[0x1C] & 0x60);
+	
+	return channels[channel].volume == 0;
+}
+
+uint8_t APU::Read(uint16_t address)
+{
+	// Wave RAM
+	if (address >= 0xFF30)
+		return io[address - 0xFF00];
+	
+	uint8_t mask = READ_MASKS[address - 0xFF10];
+	
+	if (address == 0xFF26)
+	{
+		// Channels turn themselves off (length, sweep)
+		CatchUp();
+		
+		uint8_t status = io[0x26] & NR52_POWER;
+		
+		for (int i = 0; i < 4; i++)
+		{
+			if (channels[i].enabled)
+				status |= 1 << i;
+		}
+		
+		return status | mask;
+	}
+	
+	return io[address - 0xFF00] | mask;
+}
+
+void APU::Write(uint16_t address, uint8_t data)
+{
+	CatchUp();
+	
+	// Wave RAM is always writable
+	if (address >= 0xFF30)
+	{
+		io[address - 0xFF00] = data;
+		UpdateOutput(CHANNEL_WAVE, time);
+		return;
+	}
+	
+	if (address == 0xFF26)
+	{
+		bool wasOn = (io[0x26] & NR52_POWER) != 0;
+		io[0x26] = data & NR52_POWER;
+		
+		if (wasOn && !(data & NR52_POWER))
+			PowerOff();
+		else if (!wasOn && (data & NR52_POWER))
+			sequencerStep = 0;
+		
+		return;
+	}
+	
+	// Powered off, only NR52 (and wave RAM) can be written
+	if (!(io[0x26] & NR52_POWER))
+		return;
+	
+	io[address - 0xFF00] = data;
+	
+	// Unused registers
+	if (address >= 0xFF27 || address == 0xFF15 || address == 0xFF1F)
+		return;
+	
+	// Volume and panning change every channel's output
+	if (address == 0xFF24 || address == 0xFF25)
+	{
+		UpdateOutputs();
+		return;
+	}
+	
+	int channel = (address - 0xFF10) / 5;
+	int reg = (address - 0xFF10) % 5;
+	Channel& c = channels[channel];
+	
+	switch (reg)
+	{
+		// Length
+		case 1:
+			if (channel == CHANNEL_WAVE)
+				c.length = 256 - data;
+			else
+				c.length = 64 - (data & 0x3F);
+			break;
+		
+		// DAC (NR30 on the wave channel, NRx2 on the others)
+		case 0:
+		case 2:
+			if (reg == ((channel == CHANNEL_WAVE)? 0 : 2) && !IsDACEnabled(channel))
+				c.enabled = false;
+			break;
+		
+		case 4:
+			if (data & NRX4_TRIGGER)
+				Trigger(channel);
+			break;
+	}
+	
+	UpdateOutput(channel, time);
+}
+
+void APU::Trigger(int channel)
+{
+	Channel& c = channels[channel];
+	uint8_t* nr = GetRegisters(channel);
+	
+	c.enabled = IsDACEnabled(channel);
+	
+	if (c.length == 0)
+		c.length = (channel == CHANNEL_WAVE)? 256 : 64;
+	
+	c.timer = GetPeriod(channel);
+	
+	if (channel == CHANNEL_WAVE)
+	{
+		c.position = 0;
+	}
+	else
+	{
+		c.volume = nr[2] >> 4;
+		c.envelopeTimer = nr[2] & 0x07;
+	}
+	
+	if (channel == CHANNEL_NOISE)
+		c.lfsr = 0x7FFF;
+	
+	if (channel == CHANNEL_SQUARE1)
+	{
+		int period = (nr[0] >> 4) & 0x07;
+		int shift = nr[0] & 0x07;
+		
+		c.sweepFrequency = GetFrequency(channel);
+		c.sweepTimer = (period)? period : 8;
+		c.sweepEnabled = period || shift;
+		
+		// Overflow check right away
+		if (shift)
+			CalculateSweep();
+	}
+}
+
+void APU::PowerOff()
+{
+	// Every register but NR52 (and the wave RAM) is cleared
+	memset(&io[0x10], 0, 0x16);
+	
+	for (int i = 0; i < 4; i++)
+		channels[i].enabled = false;
+	
+	UpdateOutputs();
+}
+
+void APU::CatchUp()
+{
+	Run(cpu->cycleCount);
+}
+
+void APU::Run(uint64_t end)
+{
+	while (time < end)
+	{
+		uint64_t next = (sequencerTime < end)? sequencerTime : end;
+		
+		// Without a sink the waveforms don't matter
+		if (sink)
+		{
+			for (int i = 0; i < 4; i++)
+				RunChannel(i, next);
+		}
+		
+		time = next;
+		
+		if (time == sequencerTime)
+		{
+			sequencerTime += SEQUENCER_CLOCKS;
+			ClockSequencer();
+		}
+		
+		if (sink && time - frameStart >= MAX_FRAME_CLOCKS)
+			Flush();
+	}
+}
+
+void APU::RunChannel(int channel, uint64_t end)
+{
+	Channel& c = channels[channel];
+	int period = GetPeriod(channel);
+	
+	if (!c.enabled || !period)
+		return;
+	
+	uint64_t t = time + c.timer;
+	
+	// Silent for the whole run (levels only change between runs), skip
+	// to where the waveform would be (the noise LFSR can stay put)
+	if (IsSilent(channel))
+	{
+		if (t < end)
+		{
+			uint64_t steps = (end - t + period - 1) / period;
+			c.position = (int32_t)((c.position + steps) & ((channel == CHANNEL_WAVE)? 31 : 7));
+			t += steps * period;
+		}
+		
+		c.timer = (int32_t)(t - end);
+		return;
+	}
+	
+	while (t < end)
+	{
+		switch (channel)
+		{
+			case CHANNEL_SQUARE1:
+			case CHANNEL_SQUARE2:
+				c.position = (c.position + 1) & 7;
+				break;
+			
+			case CHANNEL_WAVE:
+				c.position = (c.position + 1) & 31;
+				break;
+			
+			default:
+			{
+				// 15 bit LFSR (7 bit with NR43 bit 3)
+				int bit = (c.lfsr ^ (c.lfsr >> 1)) & 1;
+				c.lfsr = (c.lfsr >> 1) | (bit << 14);
+				
+				if (io[0x22] & 0x08)
+					c.lfsr = (c.lfsr & ~0x40) | (bit << 6);
+				break;
+			}
+		}
+		
+		UpdateOutput(channel, t);
+		t += period;
+	}
+	
+	c.timer = (int32_t)(t - end);
+}
+
+void APU::ClockSequencer()
+{
+	if (!(io[0x26] & NR52_POWER))
+		return;
+	
+	if (!(sequencerStep & 1))
+		ClockLength();
+	
+	if (sequencerStep == 2 || sequencerStep == 6)
+		ClockSweep();
+	
+	if (sequencerStep == 7)
+		ClockEnvelope();
+	
+	sequencerStep = (sequencerStep + 1) & 7;
+	
+	UpdateOutputs();
+}
+
+void APU::ClockLength()
+{
+	for (int i = 0; i < 4; i++)
+	{
+		Channel& c = channels[i];
+		
+		if ((GetRegisters(i)[4] & NRX4_LENGTH_ENABLE) && c.length > 0)
+		{
+			if (--c.length == 0)
+				c.enabled = false;
+		}
+	}
+}
+
+int APU::CalculateSweep()
+{
+	Channel& c = channels[CHANNEL_SQUARE1];
+	uint8_t nr10 = io[0x10];
+	
+	int delta = c.sweepFrequency >> (nr10 & 0x07);
+	int frequency = (nr10 & 0x08)? c.sweepFrequency - delta : c.sweepFrequency + delta;
+	
+	if (frequency > 2047)
+		c.enabled = false;
+	
+	return frequency;
+}
+
+void APU::ClockSweep()
+{
+	Channel& c = channels[CHANNEL_SQUARE1];
+	uint8_t nr10 = io[0x10];
+	int period = (nr10 >> 4) & 0x07;
+	
+	if (--c.sweepTimer > 0)
+		return;
+	
+	c.sweepTimer = (period)? period : 8;
+	
+	if (!c.sweepEnabled || !period)
+		return;
+	
+	int frequency = CalculateSweep();
+	
+	if (frequency <= 2047 && (nr10 & 0x07))
+	{
+		c.sweepFrequency = frequency;
+		io[0x13] = frequency & 0xFF;
+		io[0x14] = (io[0x14] & ~0x07) | (frequency >> 8);
+		
+		// And checked again with the new frequency
+		CalculateSweep();
+	}
+}
+
+void APU::ClockEnvelope()
+{
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == CHANNEL_WAVE)
+			continue;
+		
+		Channel& c = channels[i];
+		uint8_t nr2 = GetRegisters(i)[2];
+		int period = nr2 & 0x07;
+		
+		if (!period || --c.envelopeTimer > 0)
+			continue;
+		
+		c.envelopeTimer = period;
+		
+		if ((nr2 & 0x08) && c.volume < 15)
+			c.volume++;
+		else if (!(nr2 & 0x08) && c.volume > 0)
+			c.volume--;
+	}
+}
+
+void APU::UpdateOutput(int channel, uint64_t when)
+{
+	if (!sink)
+		return;
+	
+	int amplitude = GetAmplitude(channel);
+	uint8_t nr50 = io[0x24];
+	uint8_t nr51 = io[0x25];
+	
+	// Left is NR50 bits 4-6 and NR51 bits 4-7, right the low bits
+	for (int side = 0; side < 2; side++)
+	{
+		int shift = (side == 0)? 4 : 0;
+		int level = 0;
+		
+		if (nr51 & (1 << (channel + shift)))
+			level = amplitude * (((nr50 >> shift) & 0x07) + 1);
+		
+		if (level != output[channel][side])
+		{
+			buffers[side].AddDelta((uint32_t)(when - frameStart), (level - output[channel][side]) * OUTPUT_UNIT);
+			output[channel][side] = level;
+		}
+	}
+}
+
+void APU::UpdateOutputs()
+{
+	for (int i = 0; i < 4; i++)
+		UpdateOutput(i, time);
+}
+
+void APU::Flush()
+{
+	uint32_t length = (uint32_t)(time - frameStart);
+	
+	buffers[0].EndFrame(length);
+	buffers[1].EndFrame(length);
+	frameStart = time;
+	
+	int count = buffers[0].ReadSamples(samples, BlipBuffer::MAX_SAMPLES, 2);
+	buffers[1].ReadSamples(samples + 1, count, 2);
+	
+	if (count)
+		sink->OnSamples(samples, count);
+}
+
+void APU::EndFrame()
+{
+	CatchUp();
+	
+	if (sink)
+		Flush();
+	else
+		frameStart = time;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef __APU__
+#define __APU__
+
+#include <stdint.h>
+#include "cpu.h"
+#include "blip_buffer.h"
+#include "aligned.h"
+
+class Memory;
+
+/*
+ * Whatever plays the sound.
+ * Gets the samples of every frame (interleaved stereo, left first).
+ */
+class AudioSink
+{
+	public:
+		virtual ~AudioSink() {}
+		virtual void OnSamples(const int16_t* samples, int count) = 0;
+};
+
+/*
+ * Sound (NR10-NR52 FF10-FF26, wave RAM FF30-FF3F).
+ * Two square channels (the first with a sweep), a wave channel and a
+ * noise channel, with length, envelope and sweep clocked by a 512 Hz
+ * frame sequencer.
+ * Nothing runs per instruction: the channels catch up to the CPU's
+ * cycle count when a sound register is accessed and at the end of
+ * every frame. Level changes go into band-limited buffers, which are
+ * handed to the sink every frame.
+ * Without a sink only the frame sequencer runs (NR52 still shows
+ * which channels are on), so headless runs pay next to nothing.
+ */
+class APU : public CacheAligned
+{
+	public:
+		struct Channel
+		{
+			bool enabled;
+			int32_t length;
+			// Envelope (not the wave channel)
+			int32_t volume;
+			int32_t envelopeTimer;
+			// Clocks until the next waveform step, position in the duty/wave
+			int32_t timer;
+			int32_t position;
+			// Sweep (first square channel)
+			int32_t sweepTimer;
+			int32_t sweepFrequency;
+			bool sweepEnabled;
+			// Noise
+			uint16_t lfsr;
+		};
+		
+		// Savestate block (plain data, see savestate.h)
+		// The registers and wave RAM are in the IO region
+		struct State
+		{
+			Channel channels[4];
+			uint64_t time;
+			uint64_t sequencerTime;
+			int32_t sequencerStep;
+		};
+		
+		APU(Memory* memory, CPU* cpu);
+		~APU();
+		void Reset();
+		void SaveState(State* state);
+		void LoadState(const State* state);
+		// NULL = no sound (only what games can read is emulated)
+		void SetSink(AudioSink* sink, int sampleRate);
+		// Changes the output rate, what's already in the buffers stays
+		void SetSampleRate(double sampleRate);
+		// Runs as without a sink, the sound picks up where it left off
+		// when unmuted (frames that get thrown away, see RunAhead)
+		void SetMuted(bool muted);
+		
+		uint8_t Read(uint16_t address);
+		void Write(uint16_t address, uint8_t data);
+		
+		// Catches up and hands the frame's samples to the sink
+		void EndFrame();
+	
+	private:
+		Memory* memory;
+		CPU* cpu;
+		AudioSink* sink;
+		AudioSink* mutedSink;
+		bool muted;
+		
+		uint8_t* io;
+		
+		Channel channels[4];
+		
+		// Clock (CPU cycles at normal speed) emulated up to
+		uint64_t time;
+		// Next frame sequencer step
+		uint64_t sequencerTime;
+		int sequencerStep;
+		
+		// Output (left, right)
+		BlipBuffer buffers[2];
+		uint64_t frameStart;
+		// Level each channel has in each buffer
+		int output[4][2];
+		int16_t* samples;
+		
+		// Registers of a channel (NRx0-NRx4)
+		uint8_t* GetRegisters(int channel);
+		int GetFrequency(int channel);
+		// Clocks per waveform step (0 = not clocked)
+		int GetPeriod(int channel);
+		bool IsDACEnabled(int channel);
+		// Current level (0-15)
+		int GetAmplitude(int channel);
+		// Level stays 0 whatever the waveform does
+		bool IsSilent(int channel);
+		
+		void CatchUp();
+		void Run(uint64_t end);
+		void RunChannel(int channel, uint64_t end);
+		void Flush();
+		
+		// Frame sequencer
+		void ClockSequencer();
+		void ClockLength();
+		void ClockSweep();
+		void ClockEnvelope();
+		int CalculateSweep();
+		
+		void Trigger(int channel);
+		void PowerOff();
+		
+		// Puts a channel's level into the buffers (at time)
+		void UpdateOutput(int channel, uint64_t when);
+		void UpdateOutputs();
+};
+
+#endif
\ No newline at end of file
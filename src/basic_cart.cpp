@@ -29,3 +29,9 @@ void BasicCart::WriteRAM(uint16_t address, uint8_t data)
 {
 	printf("NO BASIC CART HAS RAM...");
 }
+
+// Basic cart has no ram
+uint8_t* BasicCart::GetRAMPtr(uint16_t address)
+{
+	return NULL;
+}
\ No newline at end of file
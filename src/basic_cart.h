@@ -19,6 +19,7 @@ class BasicCart : public Cart
 		uint8_t* GetROMPtr(uint16_t address) override;
 		uint8_t ReadRAM(uint16_t address) override;
 		void WriteRAM(uint16_t address, uint8_t data) override;
+		uint8_t* GetRAMPtr(uint16_t address) override;
 };
 
 #endif
\ No newline at end of file
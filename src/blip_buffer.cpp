@@ -0,0 +1,170 @@
+#include "blip_buffer.h"
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Impulses at 32 sub-sample offsets, each tap summing to 1 << KERNEL_BITS
+const int PHASE_BITS = 5;
+const int PHASES = 1 << PHASE_BITS;
+const int TAPS = BlipBuffer::TAPS;
+const int KERNEL_BITS = 15;
+
+// DC removal time constant (2^10 samples, ~20ms at 48 kHz)
+const int HIGHPASS_SHIFT = 10;
+
+// Cut off a bit below Nyquist (fraction of the sample rate)
+const double CUTOFF = 0.45;
+
+struct Kernel
+{
+	// 16 byte aligned rows (loaded with SSE2)
+	alignas(16) int16_t taps[PHASES][TAPS];
+	
+	Kernel()
+	{
+		const double PI = 3.14159265358979323846;
+		
+		for (int phase = 0; phase < PHASES; phase++)
+		{
+			double sum = 0;
+			double impulse[TAPS];
+			
+			// Blackman windowed sinc, centered between the middle taps + phase
+			for (int i = 0; i < TAPS; i++)
+			{
+				double x = i - (TAPS / 2 - 1) - (double)phase / PHASES;
+				double sinc = (x == 0)? 1 : sin(2 * PI * CUTOFF * x) / (2 * PI * CUTOFF * x);
+				double window = 0.42 + 0.5 * cos(2 * PI * x / TAPS) + 0.08 * cos(4 * PI * x / TAPS);
+				
+				impulse[i] = sinc * window;
+				sum += impulse[i];
+			}
+			
+			// Normalize, rounding errors go to the middle tap so a step is exact
+			int total = 0;
+			
+			for (int i = 0; i < TAPS; i++)
+			{
+				taps[phase][i] = (int16_t)floor(impulse[i] / sum * (1 << KERNEL_BITS) + 0.5);
+				total += taps[phase][i];
+			}
+			
+			taps[phase][TAPS / 2 - 1] += (1 << KERNEL_BITS) - total;
+		}
+	}
+};
+
+static const Kernel& GetKernel()
+{
+	static const Kernel kernel;
+	return kernel;
+}
+
+BlipBuffer::BlipBuffer()
+{
+	factor = 0;
+	
+	GetKernel();
+	Clear();
+}
+
+void BlipBuffer::SetRates(double clockRate, double sampleRate)
+{
+	factor = (uint64_t)(sampleRate / clockRate * 4294967296.0 + 0.5);
+}
+
+void BlipBuffer::Clear()
+{
+	memset(buffer, 0, sizeof(buffer));
+	offset = 0;
+	integrator = 0;
+	highpass = 0;
+}
+
+void BlipBuffer::AddDelta(uint32_t time, int delta)
+{
+	uint64_t position = offset + time * factor;
+	uint32_t index = (uint32_t)(position >> 32);
+	int phase = (int)(position >> (32 - PHASE_BITS)) & (PHASES - 1);
+	
+	// Frame too long for the buffer (the caller ends frames before this)
+	if (index >= MAX_SAMPLES)
+		return;
+	
+	const int16_t* taps = GetKernel().taps[phase];
+	int32_t* out = &buffer[index];
+
+#ifdef __SSE2__
+	// taps * delta, 4 at a time: taps are widened to (tap, 0) pairs and
+	// multiplied by (delta, 0) pairs with pmaddwd (deltas fit in 16 bits)
+	if (delta >= -32768 && delta <= 32767)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i scale = _mm_set1_epi32(delta & 0xFFFF);
+		
+		for (int i = 0; i < TAPS; i += 8)
+		{
+			__m128i k = _mm_load_si128((const __m128i*)&taps[i]);
+			__m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(k, zero), scale);
+			__m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(k, zero), scale);
+			
+			__m128i* dest = (__m128i*)&out[i];
+			_mm_storeu_si128(dest, _mm_add_epi32(_mm_loadu_si128(dest), lo));
+			_mm_storeu_si128(dest + 1, _mm_add_epi32(_mm_loadu_si128(dest + 1), hi));
+		}
+		
+		return;
+	}
+#endif
+	
+	for (int i = 0; i < TAPS; i++)
+		out[i] += taps[i] * delta;
+}
+
+void BlipBuffer::EndFrame(uint32_t time)
+{
+	offset += time * factor;
+	
+	if ((offset >> 32) > MAX_SAMPLES)
+		offset = (uint64_t)MAX_SAMPLES << 32;
+}
+
+int BlipBuffer::GetSamplesAvailable()
+{
+	return (int)(offset >> 32);
+}
+
+int BlipBuffer::ReadSamples(int16_t* out, int count, int stride)
+{
+	int available = GetSamplesAvailable();
+	
+	if (count > available)
+		count = available;
+	
+	for (int i = 0; i < count; i++)
+	{
+		integrator += buffer[i];
+		
+		int sample = integrator >> KERNEL_BITS;
+		int output = sample - (highpass >> HIGHPASS_SHIFT);
+		highpass += output;
+		
+		if (output > 32767)
+			output = 32767;
+		else if (output < -32768)
+			output = -32768;
+		
+		out[i * stride] = (int16_t)output;
+	}
+	
+	// Keep what's left (and the tails of the last impulses)
+	int remaining = available - count + TAPS;
+	memmove(buffer, buffer + count, remaining * sizeof(int32_t));
+	memset(buffer + remaining, 0, count * sizeof(int32_t));
+	
+	offset -= (uint64_t)count << 32;
+	return count;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef __BLIP_BUFFER__
+#define __BLIP_BUFFER__
+
+#include <stdint.h>
+
+/*
+ * Band-limited step synthesis.
+ * Sound is given as steps (changes of level) at clock times, each one
+ * is added as a windowed sinc impulse at the output sample rate, so
+ * square waves come out without aliasing and the cost only depends on
+ * how often the level changes, not on the clock rate.
+ * Output is integrated and has its DC removed (like the Gameboy's
+ * output capacitor).
+ */
+class BlipBuffer
+{
+	public:
+		// Most samples a frame can hold
+		static const int MAX_SAMPLES = 8192;
+		// Length of an impulse (latency is half of it)
+		static const int TAPS = 16;
+		
+		BlipBuffer();
+		
+		// Input clock rate and output sample rate (Hz)
+		void SetRates(double clockRate, double sampleRate);
+		void Clear();
+		
+		// Adds a step of delta at a clock time (since the frame started)
+		void AddDelta(uint32_t time, int delta);
+		// Ends the frame at a clock time, its samples can be read
+		void EndFrame(uint32_t time);
+		
+		int GetSamplesAvailable();
+		// Reads up to count samples into every stride'th int16, returns how many
+		int ReadSamples(int16_t* out, int count, int stride);
+	
+	private:
+		// Deltas (integrated on read)
+		int32_t buffer[MAX_SAMPLES + TAPS];
+		
+		// Output samples per clock, 32.32 fixed point
+		uint64_t factor;
+		// Position of the frame start in samples, 32.32 fixed point
+		uint64_t offset;
+		
+		int32_t integrator;
+		int32_t highpass;
+};
+
+#endif
\ No newline at end of file
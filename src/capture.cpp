@@ -0,0 +1,347 @@
+#include "capture.h"
+#include "delta.h"
+#include <string.h>
+#include <string>
+#include <chrono>
+
+// Frames between keyframes (a damaged file is readable again from the next)
+const uint32_t KEYFRAME_INTERVAL = 600;
+// Frame rate (4194304 Hz / 70224 clocks per frame, ~59.7275 fps)
+const uint32_t CLOCK_RATE = 4194304;
+const uint32_t FRAME_CLOCKS = 70224;
+
+const uint32_t PIXEL_BYTES = Screen::WIDTH * Screen::HEIGHT * sizeof(uint32_t);
+// Samples written at a time (per channel)
+const int SOUND_CHUNK = 4096;
+
+Capture::Capture()
+{
+	slots = new Slot[SLOTS];
+	sound = new RingBuffer<int16_t, 1 << 18>();
+	previous = new uint32_t[PIXELS];
+	buffer = new uint8_t[GetDeltaBound(PIXEL_BYTES)];
+	samples = new int16_t[SOUND_CHUNK * 2];
+	
+	next = NULL;
+	blocking = false;
+	file = NULL;
+	wav = NULL;
+	y4m = false;
+	failed = false;
+	running = false;
+	droppedFrames = 0;
+}
+
+Capture::~Capture()
+{
+	Close();
+	
+	delete[] slots;
+	delete sound;
+	delete[] previous;
+	delete[] buffer;
+	delete[] samples;
+}
+
+bool Capture::Open(const char* filename, uint64_t romHash, int sampleRate)
+{
+	Close();
+	
+	std::string name = filename;
+	y4m = name.size() > 4 && name.compare(name.size() - 4, 4, ".y4m") == 0;
+	failed = false;
+	
+	file = fopen(filename, "wb");
+	
+	if (y4m && file)
+	{
+		std::string wavName = name.substr(0, name.size() - 4) + ".wav";
+		wav = fopen(wavName.c_str(), "wb");
+		
+		if (!wav)
+		{
+			fclose(file);
+			file = NULL;
+		}
+	}
+	
+	if (!file)
+		return false;
+	
+	// Header
+	if (y4m)
+	{
+		failed = !WriteY4MHeader(file, CLOCK_RATE, FRAME_CLOCKS);
+		
+		// Sizes are filled in on close
+		this->sampleRate = sampleRate;
+		failed = !WriteWAVHeader(wav, sampleRate, 0) || failed;
+	}
+	else
+	{
+		CaptureHeader header;
+		header.magic = CAPTURE_MAGIC;
+		header.version = CAPTURE_VERSION;
+		header.romHash = romHash;
+		header.width = Screen::WIDTH;
+		header.height = Screen::HEIGHT;
+		header.sampleRate = sampleRate;
+		header.clockRate = CLOCK_RATE;
+		header.frameClocks = FRAME_CLOCKS;
+		Write(file, &header, sizeof(header));
+	}
+	
+	// Every slot starts out free
+	int index;
+	
+	while (fullSlots.Pop(index))
+		;
+	
+	while (freeSlots.Pop(index))
+		;
+	
+	for (int i = 0; i < SLOTS; i++)
+		freeSlots.Push(i);
+	
+	while (sound->Pop(samples, SOUND_CHUNK * 2))
+		;
+	
+	frame = 0;
+	droppedFrames = 0;
+	lastFrame = 0;
+	framesWritten = 0;
+	samplesWritten = 0;
+	
+	running = true;
+	thread = std::thread(&Capture::Run, this);
+	return true;
+}
+
+bool Capture::Close()
+{
+	if (!file)
+		return !failed;
+	
+	// The writer finishes what's queued first
+	running = false;
+	thread.join();
+	
+	if (wav)
+	{
+		if (!WriteWAVHeader(wav, sampleRate, samplesWritten))
+			failed = true;
+		
+		if (fclose(wav) != 0)
+			failed = true;
+		
+		wav = NULL;
+	}
+	
+	if (fclose(file) != 0)
+		failed = true;
+	
+	file = NULL;
+	return !failed;
+}
+
+bool Capture::IsOpen()
+{
+	return file != NULL;
+}
+
+void Capture::SetBlocking(bool blocking)
+{
+	this->blocking = blocking;
+}
+
+void Capture::SetNextSink(AudioSink* sink)
+{
+	next = sink;
+}
+
+int Capture::GetDroppedFrames()
+{
+	return droppedFrames;
+}
+
+void Capture::AddFrame(const uint32_t* pixels)
+{
+	if (!file)
+		return;
+	
+	int index;
+	
+	while (!freeSlots.Pop(index))
+	{
+		// Writer's behind, lose the frame rather than hold up the emulation
+		if (!blocking)
+		{
+			droppedFrames++;
+			frame++;
+			return;
+		}
+		
+		std::this_thread::yield();
+	}
+	
+	Slot* slot = &slots[index];
+	slot->frame = frame++;
+	memcpy(slot->pixels, pixels, PIXEL_BYTES);
+	fullSlots.Push(index);
+}
+
+void Capture::OnSamples(const int16_t* samples, int count)
+{
+	if (file)
+	{
+		const int16_t* data = samples;
+		size_t left = count * 2;
+		
+		while (left)
+		{
+			size_t pushed = sound->Push(data, left);
+			data += pushed;
+			left -= pushed;
+			
+			// Way behind, lose the sound (the sample indices show the gap)
+			if (!blocking)
+				break;
+			
+			if (left)
+				std::this_thread::yield();
+		}
+	}
+	
+	if (next)
+		next->OnSamples(samples, count);
+}
+
+void Capture::Run()
+{
+	while (true)
+	{
+		// Checked first, so everything queued before Close is written
+		bool stopping = !running;
+		int index;
+		bool wrote = fullSlots.Pop(index);
+		
+		if (wrote)
+		{
+			WriteFrame(&slots[index]);
+			freeSlots.Push(index);
+		}
+		
+		// Sound in big chunks (all of it at the end)
+		if (sound->Count() >= SOUND_CHUNK * 2 || stopping)
+			WriteSound();
+		
+		if (!wrote && stopping)
+			break;
+		
+		if (!wrote)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void Capture::WriteFrame(const Slot* slot)
+{
+	if (y4m)
+	{
+		// No timestamps in Y4M, dropped frames are shown for longer
+		uint32_t repeats = (framesWritten)? slot->frame - lastFrame : 1;
+		
+		for (uint32_t i = 1; i < repeats; i++)
+			failed = !WriteY4MFrame(file, previous) || failed;
+		
+		failed = !WriteY4MFrame(file, slot->pixels) || failed;
+	}
+	else if (framesWritten % KEYFRAME_INTERVAL == 0)
+	{
+		WriteChunk(CAPTURE_KEYFRAME, slot->frame, slot->pixels, PIXEL_BYTES);
+	}
+	else
+	{
+		// Most frames barely change, the delta is mostly unchanged runs
+		size_t size = EncodeDelta((const uint8_t*)previous, (const uint8_t*)slot->pixels, PIXEL_BYTES, buffer);
+		WriteChunk(CAPTURE_DELTA, slot->frame, buffer, size);
+	}
+	
+	memcpy(previous, slot->pixels, PIXEL_BYTES);
+	lastFrame = slot->frame;
+	framesWritten++;
+}
+
+void Capture::WriteSound()
+{
+	size_t count;
+	
+	while ((count = sound->Pop(samples, SOUND_CHUNK * 2)) > 0)
+	{
+		if (y4m)
+			Write(wav, samples, count * sizeof(int16_t));
+		else
+			WriteChunk(CAPTURE_SOUND, samplesWritten, samples, count * sizeof(int16_t));
+		
+		samplesWritten += count / 2;
+	}
+}
+
+void Capture::WriteChunk(uint32_t type, uint64_t time, const void* data, uint32_t size)
+{
+	CaptureChunk chunk;
+	chunk.type = type;
+	chunk.size = size;
+	chunk.time = time;
+	Write(file, &chunk, sizeof(chunk));
+	Write(file, data, size);
+}
+
+void Capture::Write(FILE* file, const void* data, size_t size)
+{
+	if (fwrite(data, size, 1, file) != 1)
+		failed = true;
+}
+
+bool WriteY4MHeader(FILE* file, uint32_t clockRate, uint32_t frameClocks)
+{
+	return fprintf(file, "YUV4MPEG2 W%d H%d F%u:%u Ip A1:1 C444\n", Screen::WIDTH, Screen::HEIGHT, clockRate, frameClocks) > 0;
+}
+
+bool WriteY4MFrame(FILE* file, const uint32_t* pixels)
+{
+	const int count = Screen::WIDTH * Screen::HEIGHT;
+	uint8_t planes[3][count];
+	
+	// BT.601 studio range, integer
+	for (int i = 0; i < count; i++)
+	{
+		int r = (pixels[i] >> 16) & 0xFF;
+		int g = (pixels[i] >> 8) & 0xFF;
+		int b = pixels[i] & 0xFF;
+		
+		planes[0][i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		planes[1][i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		planes[2][i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+	
+	return fputs("FRAME\n", file) >= 0 && fwrite(planes, sizeof(planes), 1, file) == 1;
+}
+
+bool WriteWAVHeader(FILE* file, uint32_t sampleRate, uint64_t samples)
+{
+	// PCM, little endian like the samples
+	uint32_t dataSize = (uint32_t)(samples * 4);
+	uint32_t header[11];
+	memcpy(&header[0], "RIFF", 4);
+	header[1] = 36 + dataSize;
+	memcpy(&header[2], "WAVEfmt ", 8);
+	header[4] = 16;
+	header[5] = 1 | (2 << 16);
+	header[6] = sampleRate;
+	header[7] = sampleRate * 4;
+	header[8] = 4 | (16 << 16);
+	memcpy(&header[9], "data", 4);
+	header[10] = dataSize;
+	
+	return fseek(file, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, file) == 1 && fseek(file, 0, SEEK_END) == 0;
+}
\ No newline at end of file
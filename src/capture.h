@@ -0,0 +1,137 @@
+#ifndef __CAPTURE__
+#define __CAPTURE__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <atomic>
+#include "apu.h"
+#include "screen.h"
+#include "ring_buffer.h"
+#include "aligned.h"
+
+/*
+ * Capture file (.bgbc): CaptureHeader, then chunks, each a
+ * CaptureChunk and size bytes:
+ *   CAPTURE_KEYFRAME: the frame's XRGB8888 pixels
+ *   CAPTURE_DELTA: the XOR delta (see delta.h) from the previous frame
+ *     in the file to this one
+ *   CAPTURE_SOUND: interleaved stereo int16 samples
+ * Video chunks are stamped with the frame number (gaps are dropped
+ * frames), sound chunks with the index of their first sample.
+ * tools/capture2y4m converts it to Y4M + WAV.
+ */
+const uint32_t CAPTURE_MAGIC = 0x43424742; // "BGBC"
+const uint32_t CAPTURE_VERSION = 1;
+
+const uint32_t CAPTURE_KEYFRAME = 0;
+const uint32_t CAPTURE_DELTA = 1;
+const uint32_t CAPTURE_SOUND = 2;
+
+struct CaptureHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t romHash;
+	uint16_t width;
+	uint16_t height;
+	uint32_t sampleRate;
+	// Frame rate (clockRate / frameClocks)
+	uint32_t clockRate;
+	uint32_t frameClocks;
+};
+
+struct CaptureChunk
+{
+	uint32_t type;
+	uint32_t size;
+	uint64_t time;
+};
+
+/*
+ * Records what's shown and heard, losslessly.
+ * The emulation thread only copies each frame into a free slot of a
+ * fixed pool and pushes its sound into a ring. A writer thread encodes
+ * and writes them. If it falls behind, frames are dropped (counted)
+ * rather than waited for, unless it's blocking (offline runs).
+ * Writes a .bgbc file (above), or raw 4:4:4 Y4M video plus a WAV next
+ * to it (same name, .wav) if the file name ends in .y4m.
+ * Sound has to come at a fixed rate, it can be passed on to another
+ * sink (the one that plays it).
+ */
+class Capture : public AudioSink, public CacheAligned
+{
+	public:
+		Capture();
+		~Capture();
+		
+		bool Open(const char* filename, uint64_t romHash, int sampleRate = 48000);
+		// Waits for the writer to finish, returns false if anything failed to write
+		bool Close();
+		bool IsOpen();
+		
+		// Wait for the writer instead of dropping frames
+		void SetBlocking(bool blocking);
+		// Also gets the sound (NULL = nothing)
+		void SetNextSink(AudioSink* sink);
+		
+		// EMULATION THREAD
+		void AddFrame(const uint32_t* pixels);
+		void OnSamples(const int16_t* samples, int count) override;
+		
+		int GetDroppedFrames();
+	
+	private:
+		static const int SLOTS = 32;
+		static const int PIXELS = Screen::WIDTH * Screen::HEIGHT;
+		
+		struct Slot
+		{
+			uint32_t frame;
+			uint32_t pixels[PIXELS];
+		};
+		
+		Slot* slots;
+		// Slot indices, free ones go to the emulation thread, full ones to the writer
+		RingBuffer<int, SLOTS> freeSlots;
+		RingBuffer<int, SLOTS> fullSlots;
+		// Interleaved stereo (~2.7s at 48 kHz)
+		RingBuffer<int16_t, 1 << 18>* sound;
+		
+		AudioSink* next;
+		bool blocking;
+		uint32_t frame;
+		std::atomic<int> droppedFrames;
+		
+		// WRITER THREAD
+		std::thread thread;
+		std::atomic<bool> running;
+		
+		FILE* file;
+		FILE* wav;
+		int sampleRate;
+		bool y4m;
+		bool failed;
+		
+		// Last frame written, what the next delta is against
+		uint32_t* previous;
+		uint32_t lastFrame;
+		uint32_t framesWritten;
+		uint8_t* buffer;
+		int16_t* samples;
+		uint64_t samplesWritten;
+		
+		void Run();
+		void WriteFrame(const Slot* slot);
+		void WriteSound();
+		void WriteChunk(uint32_t type, uint64_t time, const void* data, uint32_t size);
+		void Write(FILE* file, const void* data, size_t size);
+};
+
+// Writes the Y4M header, and a frame as 4:4:4 (BT.601) planes
+bool WriteY4MHeader(FILE* file, uint32_t clockRate, uint32_t frameClocks);
+bool WriteY4MFrame(FILE* file, const uint32_t* pixels);
+// Writes (or rewrites) the header of a 16 bit stereo WAV, leaves the file at its end
+bool WriteWAVHeader(FILE* file, uint32_t sampleRate, uint64_t samples);
+
+#endif
\ No newline at end of file
@@ -1,53 +1,66 @@
 #include "cart.h"
 #include "basic_cart.h"
 #include "mbc1_cart.h"
+#include "mbc3_cart.h"
+#include "mbc5_cart.h"
 #include <iostream>
 #include <fstream>
+#include <string.h>
 
 using namespace std;
 
-char* GetBytes(char* filename)
+uint8_t* GetBytes(const char* filename, size_t* size)
 {
-	char* bytes;
+	uint8_t* bytes;
 	
 	// LOAD THE CART
 	// Create filestream
-	ifstream ifs(filename);
+	ifstream ifs(filename, ios::binary);
+	
+	if (!ifs)
+	{
+		fprintf(stderr, "Could not open %s\n", filename);
+		return NULL;
+	}
+	
 	ifs.seekg(0, ios::end);
 	// Get size of file
 	size_t len = ifs.tellg();
 	
-	printf("Loaded rom of size %i bytes\n", len);
+	fprintf(stderr, "Loaded rom of size %i bytes\n", (int)len);
 	
 	// Create array for rom
-	bytes = new char[len];
+	bytes = new uint8_t[len];
 	
 	// Seek to beginning and read
 	ifs.seekg(0, ios::beg);
-	ifs.read(bytes, len);
+	ifs.read((char*)bytes, len);
 	
 	// close file
 	ifs.close();
 	
+	*size = len;
 	return bytes;
 }
 
 int GetRAMSize(uint8_t ramType)
 {
-	printf("RAM SIZE 0x%02x\n", ramType);
+	fprintf(stderr, "RAM SIZE 0x%02x\n", ramType);
 	switch (ramType)
 	{
 		case 0x00: return 0x0000;
 		case 0x01: return 0x0800;
 		case 0x02: return 0x2000;
 		case 0x03: return 0x8000;
+		case 0x04: return 0x20000;
+		case 0x05: return 0x10000;
 		default: return 0;
 	}
 }
 
 Cart* CreateSuitableCart(uint8_t type, uint8_t ramType)
 {
-	printf("CART: 0x%02x\n", type); 
+	fprintf(stderr, "CART: 0x%02x\n", type); 
 	
 	switch (type)
 	{
@@ -55,22 +68,59 @@ Cart* CreateSuitableCart(uint8_t type, uint8_t ramType)
 		case 0x01: return new MBC1Cart();
 		case 0x02: return new MBC1Cart(GetRAMSize(ramType));
 		case 0x03: return new MBC1Cart(GetRAMSize(ramType), true);
+		case 0x0F: return new MBC3Cart(0, true);
+		case 0x10: return new MBC3Cart(GetRAMSize(ramType), true);
+		case 0x11: return new MBC3Cart();
+		case 0x12: return new MBC3Cart(GetRAMSize(ramType));
+		case 0x13: return new MBC3Cart(GetRAMSize(ramType), true);
+		case 0x19: return new MBC5Cart();
+		case 0x1A: return new MBC5Cart(GetRAMSize(ramType));
+		case 0x1B: return new MBC5Cart(GetRAMSize(ramType), true);
+		case 0x1C: return new MBC5Cart();
+		case 0x1D: return new MBC5Cart(GetRAMSize(ramType));
+		case 0x1E: return new MBC5Cart(GetRAMSize(ramType), true);
 		default : return NULL;
 	}
 }
 
-Cart* Cart::Load(char* filename)
+Cart* Cart::Load(const char* filename)
 {
 	Cart* cart;
 	uint8_t* rom;
+	size_t size;
 	
 	// Get file
-	rom = (uint8_t*) GetBytes(filename);
+	rom = GetBytes(filename, &size);
+	
+	if (!rom)
+		return NULL;
+	
+	cart = Load(rom, size);
+	delete[] rom;
+	
+	return cart;
+}
+
+Cart* Cart::Load(const uint8_t* data, size_t size)
+{
+	Cart* cart;
+	
+	// Too small to have a header
+	if (size < 0x150)
+		return NULL;
 	
 	// Initialize based on Header
-	cart = CreateSuitableCart(rom[0x147], rom[0x149]);
-	cart->isCGB = rom[0x143] & 0x80;
-	cart->rom = rom;
+	cart = CreateSuitableCart(data[0x147], data[0x149]);
+	
+	if (!cart)
+		return NULL;
+	
+	cart->isCGB = data[0x143] & 0x80;
+	
+	// Keep a copy of the ROM
+	cart->rom = new uint8_t[size];
+	cart->romSize = size;
+	memcpy(cart->rom, data, size);
 	
 	return cart;
 }
@@ -79,8 +129,23 @@ Cart::Cart(int ramSize, bool hasBattery)
 {
 	if (ramSize)
 	{
-		ram = (uint8_t*) new char[ramSize];
+		ram = (uint8_t*)AlignedAlloc(ramSize);
+		memset(ram, 0, ramSize);
 	}
+	else
+	{
+		ram = NULL;
+	}
+	
+	rom = NULL;
+	romSize = 0;
+	this->ramSize = ramSize;
 	
 	this->hasBattery = hasBattery;
+}
+
+Cart::~Cart()
+{
+	delete[] rom;
+	AlignedFree(ram);
 }
\ No newline at end of file
@@ -2,29 +2,59 @@
 #define __CART__
 
 #include <stdint.h>
+#include <stddef.h>
+#include "aligned.h"
+
+// MBC registers in a savestate (the layout is up to each MBC)
+struct CartState
+{
+	uint8_t registers[16];
+};
 
 /*
  * Cart interface
  */
-class Cart
+class Cart : public CacheAligned
 {
 	public:
 		bool isCGB;
 		bool hasBattery;
 	
-		static Cart* Load(char* filename);
+		// Return NULL if the file can't be read or the cart type is unsupported
+		static Cart* Load(const char* filename);
+		static Cart* Load(const uint8_t* data, size_t size);
 		
 		Cart(int ramSize, bool hasBattery);
+		virtual ~Cart();
 		void SetROM(uint8_t* rom);
 		virtual uint8_t ReadROM(uint16_t address) = 0;
 		virtual void WriteROM(uint16_t address, uint8_t data) = 0;
 		virtual uint8_t* GetROMPtr(uint16_t address) = 0;
 		virtual uint8_t ReadRAM(uint16_t address) = 0;
 		virtual void WriteRAM(uint16_t address, uint8_t data) = 0;
+		virtual uint8_t* GetRAMPtr(uint16_t address) = 0;
+		
+		// Resets the MBC registers (RAM is kept, like a power cycle)
+		virtual void Reset() {}
+		
+		// Savestates (carts without an MBC have nothing to save)
+		virtual void SaveState(CartState* state) {}
+		virtual void LoadState(const CartState* state) {}
+		
+		// The whole ROM
+		const uint8_t* GetROM() { return rom; }
+		size_t GetROMSize() { return romSize; }
+		
+		// All of the cart's RAM (NULL if it has none)
+		uint8_t* GetRAM() { return ram; }
+		int GetRAMSize() { return ramSize; }
 		
 	protected:
 		uint8_t* rom;
 		uint8_t* ram;
+		// Sizes in bytes (powers of 2, banks past the end wrap)
+		size_t romSize;
+		int ramSize;
 };
 
 #endif
\ No newline at end of file
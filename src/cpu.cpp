@@ -1,15 +1,11 @@
 #include "cpu.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <SDL.h>
 #include <iostream>
 #include <fstream>
 
-bool OPCODE_DEBUG = false;
-extern bool MEM_DEBUG;
-extern std::ofstream* log;
-
 const int CYCLES_PER_SECOND = 4194304;
+const int SPEED_SWITCH_CYCLES = 8200;
 
 // F REGISTER FLAGS
 const int FLAG_CARRY = 1 << 4;
@@ -40,9 +36,10 @@ const int JOYPAD_ADDR = 0x60;
 
 // TIMER
 
-CPU::CPU(Memory* memory)
+CPU::CPU(Memory* memory, Debug* debug)
 {
 	this->memory = memory;
+	this->debug = debug;
 	
 	Setup();
 }
@@ -57,11 +54,23 @@ void CPU::Reset()
 	registers.pc = 0x0100;
 	registers.sp = 0xFFFE;
 	
+	// Games check for A == 0x11 to detect a CGB
+	if (memory->cart->isCGB)
+		registers.af = 0x1180;
+	
 	// State
 	interruptMaster = true;
 	imeState = 0;
 	isHalted = false;
 	isStopped = false;
+	speedShift = 0;
+	
+	// Timers
+	divCycles = 0;
+	timerCycles = 0;
+	
+	instructionCount = 0;
+	cycleCount = 0;
 	
 	// Link to memory
 	div 	= &memory->io[0x04];
@@ -70,6 +79,37 @@ void CPU::Reset()
 	tac 	= &memory->io[0x07];
 	interruptFlags 		= &memory->io[0x0F];
 	interruptsEnabled 	= &memory->io[0xFF];
+	key1	= &memory->io[0x4D];
+}
+
+void CPU::SaveState(State* state)
+{
+	state->registers = registers;
+	state->instructionCount = instructionCount;
+	state->cycleCount = cycleCount;
+	state->lastInstructionCycles = lastInstructionCycles;
+	state->speedShift = speedShift;
+	state->imeState = imeState;
+	state->divCycles = divCycles;
+	state->timerCycles = timerCycles;
+	state->interruptMaster = interruptMaster;
+	state->isHalted = isHalted;
+	state->isStopped = isStopped;
+}
+
+void CPU::LoadState(const State* state)
+{
+	registers = state->registers;
+	instructionCount = state->instructionCount;
+	cycleCount = state->cycleCount;
+	lastInstructionCycles = state->lastInstructionCycles;
+	speedShift = state->speedShift;
+	imeState = state->imeState;
+	divCycles = state->divCycles;
+	timerCycles = state->timerCycles;
+	interruptMaster = state->interruptMaster;
+	isHalted = state->isHalted;
+	isStopped = state->isStopped;
 }
 
 void CPU::Step()
@@ -78,6 +118,7 @@ void CPU::Step()
 	if (isStopped)
 	{
 		lastInstructionCycles = 4;
+		cycleCount += lastInstructionCycles;
 		return;
 	}
 	else
@@ -88,8 +129,7 @@ void CPU::Step()
 		// Manual breakpoints
 		if (registers.pc == 0x3804)//0x361A)//0x98E)
 		{
-			//MEM_DEBUG = true;
-			//OPCODE_DEBUG = true;
+			//debug->opcodes = true;
 			//printf("Last addr 0x%04x", Pop16());
 		}
 		
@@ -123,8 +163,13 @@ void CPU::Step()
 			ExecuteOpcode();
 		}
 		
+		// CPU is paused while a HDMA/GDMA transfer runs
+		lastInstructionCycles += memory->dmaCycles;
+		memory->dmaCycles = 0;
+		
 		divCycles += lastInstructionCycles;
 		timerCycles += lastInstructionCycles;
+		cycleCount += lastInstructionCycles >> speedShift;
 		
 		UpdateTimer();
 	}
@@ -193,11 +238,9 @@ void CPU::ExecuteOpcode()
 		instruction = instructions[opcode + 256];
 		lastInstructionCycles += instructionCycles[opcode + 256];
 		
-		//*log << (uint8_t)0xCB;
-		
 		if (instruction.function == NULL)
 		{
-			printf("Unimplemented instruction CB 0x%02X at 0x%04x\n", opcode, registers.pc - 1);
+			fprintf(stderr, "Unimplemented instruction CB 0x%02X at 0x%04x\n", opcode, registers.pc - 1);
 			exit(EXIT_FAILURE);
 		}
 	}
@@ -208,13 +251,13 @@ void CPU::ExecuteOpcode()
 		
 		if (instruction.function == NULL)
 		{
-			printf("Unimplemented instruction 0x%02X at 0x%04x\n", opcode, registers.pc - 1);
+			fprintf(stderr, "Unimplemented instruction 0x%02X at 0x%04x\n", opcode, registers.pc - 1);
 			exit(EXIT_FAILURE);
 		}
 	}
 	
 	// DEBUG
-	if (OPCODE_DEBUG)
+	if (debug->opcodes)
 	{
 		printf("0x%02X ", opcode);
 	
@@ -240,16 +283,17 @@ void CPU::ExecuteOpcode()
 		char c = std::cin.get();
 		if (c == 'n')
 		{
-			OPCODE_DEBUG = false;
+			debug->opcodes = false;
 			std::cin.get();
 		}
 	}
 	
 	// Execute instruction
 	(this->*(instruction.function))();
+	instructionCount++;
 		
 	// DEBUG
-	if (OPCODE_DEBUG)
+	if (debug->opcodes)
 	{
 		printf("%i CYCLES\n\n", lastInstructionCycles);
 	}
@@ -302,7 +346,8 @@ void CPU::UpdateTimer()
 
 void CPU::Setup()
 {
-	instructions = new Instruction[512]
+	// Shared by every CPU
+	static const Instruction INSTRUCTIONS[512] =
 	{
 		// 0x00
 		{"NOP", 0, &CPU::Instr0x00},
@@ -323,7 +368,7 @@ void CPU::Setup()
 		{"RRCA", 0, &CPU::Instr0x0F},
 		
 		// 0x10
-		{"STOP", 0, &CPU::Instr0x00},
+		{"STOP", 0, &CPU::Instr0x10},
 		{"LD DE, 0x%04X", 2, &CPU::Instr0x11},
 		{"LD (DE), A", 0, &CPU::Instr0x12},
 		{"INC DE", 0, &CPU::Instr0x13},
@@ -883,7 +928,9 @@ void CPU::Setup()
 		
 	};
 	
-	instructionCycles = new int[512]
+	instructions = INSTRUCTIONS;
+	
+	static const int INSTRUCTION_CYCLES[512] =
 	{
 		 4, 12,  8,  8,  4,  4,  8,  8, 20,  8,  8,  8,  4,  4,  8,  8,
 		 4, 12,  8,  8,  4,  4,  8,  8,  8,  8,  8,  8,  4,  4,  8,  8,
@@ -919,6 +966,8 @@ void CPU::Setup()
 		8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8,
 		8,  8,  8,  8,  8,  8, 16,  8,  8,  8,  8,  8,  8,  8, 16,  8  
 	};
+	
+	instructionCycles = INSTRUCTION_CYCLES;
 }
 
 // FLAGS
@@ -972,8 +1021,22 @@ void CPU::Instr0x76()
 // STOP
 void CPU::Instr0x10()
 {
+	// STOP is followed by an unused byte
+	registers.pc++;
+	
+	// On CGB, STOP switches speed if requested in KEY1
+	if (memory->cart->isCGB && (*key1 & 0x01))
+	{
+		speedShift ^= 1;
+		*key1 = (speedShift << 7) | 0x7E;
+		
+		// The switch takes 2050 M-cycles
+		lastInstructionCycles += SPEED_SWITCH_CYCLES;
+		return;
+	}
+	
 	// Stop CPU until button is pressed
-	isStopped = false;
+	isStopped = true;
 }
 
 // INTERRUPTS
@@ -1645,7 +1708,12 @@ void CPU::Instr0xCB02() { RLC(&registers.d); }
 void CPU::Instr0xCB03() { RLC(&registers.e); }
 void CPU::Instr0xCB04() { RLC(&registers.h); }
 void CPU::Instr0xCB05() { RLC(&registers.l); }
-void CPU::Instr0xCB06() { RLC(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB06() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	RLC(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // RL
 void CPU::RL(uint8_t* data, bool checkZero = true)
@@ -1672,7 +1740,12 @@ void CPU::Instr0xCB12() { RL(&registers.d); }
 void CPU::Instr0xCB13() { RL(&registers.e); }
 void CPU::Instr0xCB14() { RL(&registers.h); }
 void CPU::Instr0xCB15() { RL(&registers.l); }
-void CPU::Instr0xCB16() { RL(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB16() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	RL(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // RRC
 void CPU::RRC(uint8_t* data, bool checkZero = true)
@@ -1702,7 +1775,12 @@ void CPU::Instr0xCB0A() { RRC(&registers.d); }
 void CPU::Instr0xCB0B() { RRC(&registers.e); }
 void CPU::Instr0xCB0C() { RRC(&registers.h); }
 void CPU::Instr0xCB0D() { RRC(&registers.l); }
-void CPU::Instr0xCB0E() { RRC(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB0E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	RRC(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // RR
 void CPU::RR(uint8_t* data, bool checkZero = true)
@@ -1729,7 +1807,12 @@ void CPU::Instr0xCB1A() { RR(&registers.d); }
 void CPU::Instr0xCB1B() { RR(&registers.e); }
 void CPU::Instr0xCB1C() { RR(&registers.h); }
 void CPU::Instr0xCB1D() { RR(&registers.l); }
-void CPU::Instr0xCB1E() { RR(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB1E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	RR(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // SHIFTS
 void CPU::SLA(uint8_t* data)
@@ -1752,7 +1835,12 @@ void CPU::Instr0xCB22() { SLA(&registers.d); }
 void CPU::Instr0xCB23() { SLA(&registers.e); }
 void CPU::Instr0xCB24() { SLA(&registers.h); }
 void CPU::Instr0xCB25() { SLA(&registers.l); }
-void CPU::Instr0xCB26() { SLA(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB26() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	SLA(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::SRA(uint8_t* data)
 {
@@ -1775,7 +1863,12 @@ void CPU::Instr0xCB2A() { SRA(&registers.d); }
 void CPU::Instr0xCB2B() { SRA(&registers.e); }
 void CPU::Instr0xCB2C() { SRA(&registers.h); }
 void CPU::Instr0xCB2D() { SRA(&registers.l); }
-void CPU::Instr0xCB2E() { SRA(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB2E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	SRA(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::SRL(uint8_t* data)
 {
@@ -1797,7 +1890,12 @@ void CPU::Instr0xCB3A() { SRL(&registers.d); }
 void CPU::Instr0xCB3B() { SRL(&registers.e); }
 void CPU::Instr0xCB3C() { SRL(&registers.h); }
 void CPU::Instr0xCB3D() { SRL(&registers.l); }
-void CPU::Instr0xCB3E() { SRL(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB3E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	SRL(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // SWAP
 void CPU::Swap(uint8_t* data)
@@ -1818,7 +1916,12 @@ void CPU::Instr0xCB32() { Swap(&registers.d); }
 void CPU::Instr0xCB33() { Swap(&registers.e); }
 void CPU::Instr0xCB34() { Swap(&registers.h); }
 void CPU::Instr0xCB35() { Swap(&registers.l); }
-void CPU::Instr0xCB36() { Swap(memory->GetBytePointer(registers.hl)); }
+void CPU::Instr0xCB36() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Swap(&data);
+	memory->SetByte(registers.hl, data);
+}
 
 // BITS
 void CPU::Bit(uint8_t* data, int bit)
@@ -1839,7 +1942,11 @@ void CPU::Instr0xCB42() { Bit(&registers.d, 0); }
 void CPU::Instr0xCB43() { Bit(&registers.e, 0); }
 void CPU::Instr0xCB44() { Bit(&registers.h, 0); }
 void CPU::Instr0xCB45() { Bit(&registers.l, 0); }
-void CPU::Instr0xCB46() { Bit(memory->GetBytePointer(registers.hl), 0); }
+void CPU::Instr0xCB46() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 0);
+}
 
 void CPU::Instr0xCB4F() { Bit(&registers.a, 1); }
 void CPU::Instr0xCB48() { Bit(&registers.b, 1); }
@@ -1848,7 +1955,11 @@ void CPU::Instr0xCB4A() { Bit(&registers.d, 1); }
 void CPU::Instr0xCB4B() { Bit(&registers.e, 1); }
 void CPU::Instr0xCB4C() { Bit(&registers.h, 1); }
 void CPU::Instr0xCB4D() { Bit(&registers.l, 1); }
-void CPU::Instr0xCB4E() { Bit(memory->GetBytePointer(registers.hl), 1); }
+void CPU::Instr0xCB4E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 1);
+}
 
 void CPU::Instr0xCB57() { Bit(&registers.a, 2); }
 void CPU::Instr0xCB50() { Bit(&registers.b, 2); }
@@ -1857,7 +1968,11 @@ void CPU::Instr0xCB52() { Bit(&registers.d, 2); }
 void CPU::Instr0xCB53() { Bit(&registers.e, 2); }
 void CPU::Instr0xCB54() { Bit(&registers.h, 2); }
 void CPU::Instr0xCB55() { Bit(&registers.l, 2); }
-void CPU::Instr0xCB56() { Bit(memory->GetBytePointer(registers.hl), 2); }
+void CPU::Instr0xCB56() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 2);
+}
 
 void CPU::Instr0xCB5F() { Bit(&registers.a, 3); }
 void CPU::Instr0xCB58() { Bit(&registers.b, 3); }
@@ -1879,7 +1994,11 @@ void CPU::Instr0xCB62() { Bit(&registers.d, 4); }
 void CPU::Instr0xCB63() { Bit(&registers.e, 4); }
 void CPU::Instr0xCB64() { Bit(&registers.h, 4); }
 void CPU::Instr0xCB65() { Bit(&registers.l, 4); }
-void CPU::Instr0xCB66() { Bit(memory->GetBytePointer(registers.hl), 4); }
+void CPU::Instr0xCB66() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 4);
+}
 
 void CPU::Instr0xCB6F() { Bit(&registers.a, 5); }
 void CPU::Instr0xCB68() { Bit(&registers.b, 5); }
@@ -1888,7 +2007,11 @@ void CPU::Instr0xCB6A() { Bit(&registers.d, 5); }
 void CPU::Instr0xCB6B() { Bit(&registers.e, 5); }
 void CPU::Instr0xCB6C() { Bit(&registers.h, 5); }
 void CPU::Instr0xCB6D() { Bit(&registers.l, 5); }
-void CPU::Instr0xCB6E() { Bit(memory->GetBytePointer(registers.hl), 5); }
+void CPU::Instr0xCB6E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 5);
+}
 
 void CPU::Instr0xCB77() { Bit(&registers.a, 6); }
 void CPU::Instr0xCB70() { Bit(&registers.b, 6); }
@@ -1897,7 +2020,11 @@ void CPU::Instr0xCB72() { Bit(&registers.d, 6); }
 void CPU::Instr0xCB73() { Bit(&registers.e, 6); }
 void CPU::Instr0xCB74() { Bit(&registers.h, 6); }
 void CPU::Instr0xCB75() { Bit(&registers.l, 6); }
-void CPU::Instr0xCB76() { Bit(memory->GetBytePointer(registers.hl), 6); }
+void CPU::Instr0xCB76() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 6);
+}
 
 void CPU::Instr0xCB7F() { Bit(&registers.a, 7); }
 void CPU::Instr0xCB78() { Bit(&registers.b, 7); }
@@ -1906,7 +2033,11 @@ void CPU::Instr0xCB7A() { Bit(&registers.d, 7); }
 void CPU::Instr0xCB7B() { Bit(&registers.e, 7); }
 void CPU::Instr0xCB7C() { Bit(&registers.h, 7); }
 void CPU::Instr0xCB7D() { Bit(&registers.l, 7); }
-void CPU::Instr0xCB7E() { Bit(memory->GetBytePointer(registers.hl), 7); }
+void CPU::Instr0xCB7E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Bit(&data, 7);
+}
 
 // RESET BIT
 void CPU::Res(uint8_t* data, int bit)
@@ -1921,7 +2052,12 @@ void CPU::Instr0xCB82() { Res(&registers.d, 0); }
 void CPU::Instr0xCB83() { Res(&registers.e, 0); }
 void CPU::Instr0xCB84() { Res(&registers.h, 0); }
 void CPU::Instr0xCB85() { Res(&registers.l, 0); }
-void CPU::Instr0xCB86() { Res(memory->GetBytePointer(registers.hl), 0); }
+void CPU::Instr0xCB86() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 0);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCB8F() { Res(&registers.a, 1); }
 void CPU::Instr0xCB88() { Res(&registers.b, 1); }
@@ -1930,7 +2066,12 @@ void CPU::Instr0xCB8A() { Res(&registers.d, 1); }
 void CPU::Instr0xCB8B() { Res(&registers.e, 1); }
 void CPU::Instr0xCB8C() { Res(&registers.h, 1); }
 void CPU::Instr0xCB8D() { Res(&registers.l, 1); }
-void CPU::Instr0xCB8E() { Res(memory->GetBytePointer(registers.hl), 1); }
+void CPU::Instr0xCB8E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 1);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCB97() { Res(&registers.a, 2); }
 void CPU::Instr0xCB90() { Res(&registers.b, 2); }
@@ -1939,7 +2080,12 @@ void CPU::Instr0xCB92() { Res(&registers.d, 2); }
 void CPU::Instr0xCB93() { Res(&registers.e, 2); }
 void CPU::Instr0xCB94() { Res(&registers.h, 2); }
 void CPU::Instr0xCB95() { Res(&registers.l, 2); }
-void CPU::Instr0xCB96() { Res(memory->GetBytePointer(registers.hl), 2); }
+void CPU::Instr0xCB96() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 2);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCB9F() { Res(&registers.a, 3); }
 void CPU::Instr0xCB98() { Res(&registers.b, 3); }
@@ -1948,7 +2094,12 @@ void CPU::Instr0xCB9A() { Res(&registers.d, 3); }
 void CPU::Instr0xCB9B() { Res(&registers.e, 3); }
 void CPU::Instr0xCB9C() { Res(&registers.h, 3); }
 void CPU::Instr0xCB9D() { Res(&registers.l, 3); }
-void CPU::Instr0xCB9E() { Res(memory->GetBytePointer(registers.hl), 3); }
+void CPU::Instr0xCB9E() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 3);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBA7() { Res(&registers.a, 4); }
 void CPU::Instr0xCBA0() { Res(&registers.b, 4); }
@@ -1957,7 +2108,12 @@ void CPU::Instr0xCBA2() { Res(&registers.d, 4); }
 void CPU::Instr0xCBA3() { Res(&registers.e, 4); }
 void CPU::Instr0xCBA4() { Res(&registers.h, 4); }
 void CPU::Instr0xCBA5() { Res(&registers.l, 4); }
-void CPU::Instr0xCBA6() { Res(memory->GetBytePointer(registers.hl), 4); }
+void CPU::Instr0xCBA6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 4);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBAF() { Res(&registers.a, 5); }
 void CPU::Instr0xCBA8() { Res(&registers.b, 5); }
@@ -1966,7 +2122,12 @@ void CPU::Instr0xCBAA() { Res(&registers.d, 5); }
 void CPU::Instr0xCBAB() { Res(&registers.e, 5); }
 void CPU::Instr0xCBAC() { Res(&registers.h, 5); }
 void CPU::Instr0xCBAD() { Res(&registers.l, 5); }
-void CPU::Instr0xCBAE() { Res(memory->GetBytePointer(registers.hl), 5); }
+void CPU::Instr0xCBAE() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 5);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBB7() { Res(&registers.a, 6); }
 void CPU::Instr0xCBB0() { Res(&registers.b, 6); }
@@ -1975,7 +2136,12 @@ void CPU::Instr0xCBB2() { Res(&registers.d, 6); }
 void CPU::Instr0xCBB3() { Res(&registers.e, 6); }
 void CPU::Instr0xCBB4() { Res(&registers.h, 6); }
 void CPU::Instr0xCBB5() { Res(&registers.l, 6); }
-void CPU::Instr0xCBB6() { Res(memory->GetBytePointer(registers.hl), 6); }
+void CPU::Instr0xCBB6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 6);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBBF() { Res(&registers.a, 7); }
 void CPU::Instr0xCBB8() { Res(&registers.b, 7); }
@@ -1984,7 +2150,12 @@ void CPU::Instr0xCBBA() { Res(&registers.d, 7); }
 void CPU::Instr0xCBBB() { Res(&registers.e, 7); }
 void CPU::Instr0xCBBC() { Res(&registers.h, 7); }
 void CPU::Instr0xCBBD() { Res(&registers.l, 7); }
-void CPU::Instr0xCBBE() { Res(memory->GetBytePointer(registers.hl), 7); }
+void CPU::Instr0xCBBE() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Res(&data, 7);
+	memory->SetByte(registers.hl, data);
+}
 
 // SET BIT
 void CPU::Set(uint8_t* data, int bit)
@@ -1999,7 +2170,12 @@ void CPU::Instr0xCBC2() { Set(&registers.d, 0); }
 void CPU::Instr0xCBC3() { Set(&registers.e, 0); }
 void CPU::Instr0xCBC4() { Set(&registers.h, 0); }
 void CPU::Instr0xCBC5() { Set(&registers.l, 0); }
-void CPU::Instr0xCBC6() { Set(memory->GetBytePointer(registers.hl), 0); }
+void CPU::Instr0xCBC6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 0);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBCF() { Set(&registers.a, 1); }
 void CPU::Instr0xCBC8() { Set(&registers.b, 1); }
@@ -2008,7 +2184,12 @@ void CPU::Instr0xCBCA() { Set(&registers.d, 1); }
 void CPU::Instr0xCBCB() { Set(&registers.e, 1); }
 void CPU::Instr0xCBCC() { Set(&registers.h, 1); }
 void CPU::Instr0xCBCD() { Set(&registers.l, 1); }
-void CPU::Instr0xCBCE() { Set(memory->GetBytePointer(registers.hl), 1); }
+void CPU::Instr0xCBCE() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 1);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBD7() { Set(&registers.a, 2); }
 void CPU::Instr0xCBD0() { Set(&registers.b, 2); }
@@ -2017,7 +2198,12 @@ void CPU::Instr0xCBD2() { Set(&registers.d, 2); }
 void CPU::Instr0xCBD3() { Set(&registers.e, 2); }
 void CPU::Instr0xCBD4() { Set(&registers.h, 2); }
 void CPU::Instr0xCBD5() { Set(&registers.l, 2); }
-void CPU::Instr0xCBD6() { Set(memory->GetBytePointer(registers.hl), 2); }
+void CPU::Instr0xCBD6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 2);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBDF() { Set(&registers.a, 3); }
 void CPU::Instr0xCBD8() { Set(&registers.b, 3); }
@@ -2040,7 +2226,12 @@ void CPU::Instr0xCBE2() { Set(&registers.d, 4); }
 void CPU::Instr0xCBE3() { Set(&registers.e, 4); }
 void CPU::Instr0xCBE4() { Set(&registers.h, 4); }
 void CPU::Instr0xCBE5() { Set(&registers.l, 4); }
-void CPU::Instr0xCBE6() { Set(memory->GetBytePointer(registers.hl), 4); }
+void CPU::Instr0xCBE6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 4);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBEF() { Set(&registers.a, 5); }
 void CPU::Instr0xCBE8() { Set(&registers.b, 5); }
@@ -2049,7 +2240,12 @@ void CPU::Instr0xCBEA() { Set(&registers.d, 5); }
 void CPU::Instr0xCBEB() { Set(&registers.e, 5); }
 void CPU::Instr0xCBEC() { Set(&registers.h, 5); }
 void CPU::Instr0xCBED() { Set(&registers.l, 5); }
-void CPU::Instr0xCBEE() { Set(memory->GetBytePointer(registers.hl), 5); }
+void CPU::Instr0xCBEE() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 5);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBF7() { Set(&registers.a, 6); }
 void CPU::Instr0xCBF0() { Set(&registers.b, 6); }
@@ -2058,7 +2254,12 @@ void CPU::Instr0xCBF2() { Set(&registers.d, 6); }
 void CPU::Instr0xCBF3() { Set(&registers.e, 6); }
 void CPU::Instr0xCBF4() { Set(&registers.h, 6); }
 void CPU::Instr0xCBF5() { Set(&registers.l, 6); }
-void CPU::Instr0xCBF6() { Set(memory->GetBytePointer(registers.hl), 6); }
+void CPU::Instr0xCBF6() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 6);
+	memory->SetByte(registers.hl, data);
+}
 
 void CPU::Instr0xCBFF() { Set(&registers.a, 7); }
 void CPU::Instr0xCBF8() { Set(&registers.b, 7); }
@@ -2067,7 +2268,12 @@ void CPU::Instr0xCBFA() { Set(&registers.d, 7); }
 void CPU::Instr0xCBFB() { Set(&registers.e, 7); }
 void CPU::Instr0xCBFC() { Set(&registers.h, 7); }
 void CPU::Instr0xCBFD() { Set(&registers.l, 7); }
-void CPU::Instr0xCBFE() { Set(memory->GetBytePointer(registers.hl), 7); }
+void CPU::Instr0xCBFE() 
+{ 
+	uint8_t data = memory->ReadByte(registers.hl);
+	Set(&data, 7);
+	memory->SetByte(registers.hl, data);
+}
 
 // THE FABLED DAA
 void CPU::Instr0x27()
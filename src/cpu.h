@@ -3,8 +3,10 @@
 
 #include <stdint.h>
 #include "memory.h"
+#include "debug.h"
+#include "aligned.h"
 
-class CPU
+class CPU : public CacheAligned
 {
 	// CPU Intstruction (function pointer)
 	typedef void (CPU::*CPUInstr) (void);
@@ -47,18 +49,44 @@ class CPU
 	};
 	
 	public:
+		// Savestate block (plain data, see savestate.h)
+		struct State
+		{
+			Registers registers;
+			uint64_t instructionCount;
+			uint64_t cycleCount;
+			int32_t lastInstructionCycles;
+			int32_t speedShift;
+			int32_t imeState;
+			int32_t divCycles;
+			int32_t timerCycles;
+			bool interruptMaster;
+			bool isHalted;
+			bool isStopped;
+		};
+		
 		// # of cycles last instruction took
 		int lastInstructionCycles;
 		// if STOP was called
 		bool isStopped;
+		// 1 in CGB double speed mode (CPU cycles >> speedShift = GPU cycles)
+		int speedShift;
+		// Instructions executed since reset
+		uint64_t instructionCount;
+		// Clocks since reset (CPU cycles at normal speed, 4194304 Hz)
+		uint64_t cycleCount;
 	
-		CPU(Memory* memory);
+		CPU(Memory* memory, Debug* debug);
 		void Reset();
 		void Step();
+		void SaveState(State* state);
+		void LoadState(const State* state);
 		
 	private:
 		// Memory
 		Memory* memory;
+		// Debug switches
+		Debug* debug;
 		// Registers
 		Registers registers;
 		// If interrupts are enabled
@@ -72,6 +100,8 @@ class CPU
 		const int* instructionCycles;		
 		// Timer variables
 		uint8_t	*div, *tima, *tma, *tac;
+		// CGB speed switch (KEY1)
+		uint8_t* key1;
 		int divCycles;
 		int timerCycles;
 		// If HALT was called
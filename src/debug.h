@@ -0,0 +1,15 @@
+#ifndef __DEBUG__
+#define __DEBUG__
+
+/*
+ * Debug switches of one GameBoy (each instance has its own).
+ */
+struct Debug
+{
+	// Print every instruction and wait for enter ('n' turns it off)
+	bool opcodes;
+	
+	Debug() : opcodes(false) {}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "delta.h"
+#include <string.h>
+
+static inline uint64_t Load64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static inline uint8_t* WriteVarint(uint8_t* out, size_t value)
+{
+	while (value >= 0x80)
+	{
+		*out++ = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+static inline bool ReadVarint(const uint8_t*& in, const uint8_t* end, size_t& value)
+{
+	value = 0;
+	
+	for (int shift = 0; in < end && shift < 64; shift += 7)
+	{
+		uint8_t byte = *in++;
+		value |= (size_t)(byte & 0x7F) << shift;
+		
+		if (!(byte & 0x80))
+			return true;
+	}
+	
+	return false;
+}
+
+size_t GetDeltaBound(size_t size)
+{
+	// Every literal run ends on 8 unchanged bytes, worst case is
+	// 2 varints (up to 10 bytes each) per 9 bytes
+	return size * 2 + 32;
+}
+
+size_t EncodeDelta(const uint8_t* a, const uint8_t* b, size_t size, uint8_t* out)
+{
+	uint8_t* start = out;
+	size_t i = 0;
+	
+	while (i < size)
+	{
+		// Unchanged, a word at a time then the odd bytes
+		size_t run = i;
+		
+		while (i + 8 <= size && Load64(a + i) == Load64(b + i))
+			i += 8;
+		while (i < size && a[i] == b[i])
+			i++;
+		
+		out = WriteVarint(out, i - run);
+		
+		// Changed, until a whole unchanged word
+		run = i;
+		
+		while (i < size && !(i + 8 <= size && Load64(a + i) == Load64(b + i)))
+			i++;
+		
+		out = WriteVarint(out, i - run);
+		
+		for (size_t j = run; j < i; j++)
+			*out++ = a[j] ^ b[j];
+	}
+	
+	return out - start;
+}
+
+bool ApplyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* data, size_t size)
+{
+	const uint8_t* in = delta;
+	const uint8_t* end = delta + deltaSize;
+	size_t i = 0;
+	
+	while (in < end)
+	{
+		size_t unchanged, literals;
+		
+		if (!ReadVarint(in, end, unchanged) || !ReadVarint(in, end, literals))
+			return false;
+		
+		if (unchanged > size - i || literals > size - i - unchanged || literals > (size_t)(end - in))
+			return false;
+		
+		i += unchanged;
+		
+		for (size_t j = 0; j < literals; j++)
+			data[i + j] ^= in[j];
+		
+		i += literals;
+		in += literals;
+	}
+	
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef __DELTA__
+#define __DELTA__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * XOR delta codec.
+ * Encodes the difference of two equal sized buffers as runs of
+ * unchanged bytes and XORed literal bytes:
+ *   (varint unchanged) (varint literals) (literals)...
+ * Unchanged runs are found a word at a time, so mostly equal
+ * buffers (frame to frame savestates, screens) encode at memory speed.
+ * Applying a delta XORs it in, so it goes both ways (a -> b and b -> a).
+ */
+
+// Largest possible delta of buffers of this size
+size_t GetDeltaBound(size_t size);
+// Writes the delta of a and b to out (GetDeltaBound bytes), returns its size
+size_t EncodeDelta(const uint8_t* a, const uint8_t* b, size_t size, uint8_t* out);
+// XORs a delta into data, returns false if it doesn't fit
+bool ApplyDelta(const uint8_t* delta, size_t deltaSize, uint8_t* data, size_t size);
+
+#endif
\ No newline at end of file
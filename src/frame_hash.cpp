@@ -0,0 +1,49 @@
+#include "frame_hash.h"
+
+FrameHashLog::FrameHashLog()
+{
+	file = NULL;
+	failed = false;
+}
+
+FrameHashLog::~FrameHashLog()
+{
+	Close();
+}
+
+bool FrameHashLog::Open(const char* filename, uint64_t romHash)
+{
+	Close();
+	
+	file = fopen(filename, "wb");
+	
+	if (!file)
+		return false;
+	
+	FrameHashLogHeader header;
+	header.magic = HASHLOG_MAGIC;
+	header.version = HASHLOG_VERSION;
+	header.romHash = romHash;
+	
+	failed = fwrite(&header, sizeof(header), 1, file) != 1;
+	return !failed;
+}
+
+bool FrameHashLog::Close()
+{
+	if (!file)
+		return !failed;
+	
+	if (fclose(file) != 0)
+		failed = true;
+	
+	file = NULL;
+	return !failed;
+}
+
+void FrameHashLog::OnFrameHash(const FrameHash& hash)
+{
+	// Buffered by stdio, so it's a memcpy most frames
+	if (file && fwrite(&hash, sizeof(hash), 1, file) != 1)
+		failed = true;
+}
\ No newline at end of file
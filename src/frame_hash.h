@@ -0,0 +1,60 @@
+#ifndef __FRAME_HASH__
+#define __FRAME_HASH__
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Fingerprint of a finished frame (sent at the start of VBLANK,
+ * right after line 143 is drawn).
+ * screen: xxHash64 of the 144 line hashes (each the xxHash64 of the
+ * line's XRGB8888 pixels), lines are only rehashed when redrawn.
+ * ram: xxHash64 of HRAM (FF80-FFFE), seeded with the xxHash64 of WRAM.
+ */
+struct FrameHash
+{
+	uint32_t frame; // VBLANKs since reset
+	uint32_t rendered; // 0 if the frame was skipped (screen is the last drawn one)
+	uint64_t screen;
+	uint64_t ram;
+};
+
+class FrameHashSink
+{
+	public:
+		virtual ~FrameHashSink() {}
+		virtual void OnFrameHash(const FrameHash& hash) = 0;
+};
+
+/*
+ * Streams frame hashes to a binary file:
+ * FrameHashLogHeader, then a FrameHash per frame.
+ * Two runs are compared with tools/hashdiff.
+ */
+const uint32_t HASHLOG_MAGIC = 0x48424742; // "BGBH"
+const uint32_t HASHLOG_VERSION = 2;
+
+struct FrameHashLogHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t romHash;
+};
+
+class FrameHashLog : public FrameHashSink
+{
+	public:
+		FrameHashLog();
+		~FrameHashLog();
+		
+		bool Open(const char* filename, uint64_t romHash);
+		// Returns false if anything failed to write
+		bool Close();
+		void OnFrameHash(const FrameHash& hash) override;
+		
+	private:
+		FILE* file;
+		bool failed;
+};
+
+#endif
\ No newline at end of file
@@ -1,200 +1,499 @@
 #include "gameboy.h"
-#include <time.h>
-#include <thread>
-#include <iostream>
-#include <fstream>
+#include "savestate.h"
+#include <string.h>
 
-#ifdef _WIN32
-#include <windows.h>
+#ifdef BETTERGB_LZ4
+#include <lz4.h>
 #endif
 
-bool FRAMELIMITER_DEBUG = false;
+// Every device's State, right after the SaveStateHeader
+struct StateBlock
+{
+	CPU::State cpu;
+	GPU::State gpu;
+	Memory::State memory;
+	Joypad::State joypad;
+	Serial::State serial;
+	APU::State apu;
+	CartState cart;
+};
 
-const int SCREEN_WIDTH = 160;
-const int SCREEN_HEIGHT = 144;
+GameBoy::GameBoy()
+{
+	screen = new Screen();
+	cpu = NULL;
+	memory = NULL;
+	gpu = NULL;
+	joypad = NULL;
+	serial = NULL;
+	apu = NULL;
+	serialSink = NULL;
+	frameHashSink = NULL;
+	audioSink = NULL;
+	sampleRate = 48000;
+	inputQueue = NULL;
+	ly = NULL;
+	romCheck = 0;
+	romHash = 0;
+	stateBuffer = NULL;
+	
+	frameSkip = 1;
+	threadedRendering = false;
+}
 
-const float DESIRED_FRAME_TIME = 1/59.73;
+GameBoy::~GameBoy()
+{
+	Unload();
+	delete screen;
+}
 
-std::ofstream* log;
+bool GameBoy::LoadROM(const char* filename)
+{
+	return Load(Cart::Load(filename));
+}
 
-using namespace std::chrono;
+bool GameBoy::LoadROM(const uint8_t* data, size_t size)
+{
+	return Load(Cart::Load(data, size));
+}
 
-GameBoy::GameBoy()
+bool GameBoy::IsLoaded()
 {
-	if ( SDL_Init( SDL_INIT_VIDEO ) < 0 )
+	return memory != NULL;
+}
+
+bool GameBoy::Load(Cart* cart)
+{
+	if (!cart)
+		return false;
+	
+	Unload();
+	
+	romCheck = (cart->ReadROM(0x14D) << 16) | (cart->ReadROM(0x14E) << 8) | cart->ReadROM(0x14F);
+	
+	const uint8_t* rom = cart->GetROM();
+	romHash = 1469598103934665603ULL;
+	
+	for (size_t i = 0; i < cart->GetROMSize(); i++)
 	{
-		printf( "SDL could not initialize! SDL_error: %s\n", SDL_GetError() );
-		return;
+		romHash ^= rom[i];
+		romHash *= 1099511628211ULL;
 	}
-	else
-	{
-		char filename[MAX_PATH] = {0};
-		
-		#if _WIN32		
-		OPENFILENAME ofn;
-
-		// Get a filename to open
-		ZeroMemory(&ofn, sizeof(OPENFILENAME));
-		ofn.lStructSize = sizeof(OPENFILENAME);
-		ofn.hwndOwner = NULL;
-		ofn.lpstrFilter = "Gameboy/Gameboy Color Games\0*.gb;*.gbc\0\0";
-		ofn.lpstrFile = filename;
-		ofn.nMaxFile = MAX_PATH;
-		ofn.lpstrTitle = "Browse";
-		ofn.Flags = OFN_FILEMUSTEXIST;
-		
-		GetOpenFileName(&ofn);
-		#endif
-		
-		// Create the screen class
-		memory = new Memory(Cart::Load(filename));
-		screen = new Screen();
-		cpu = new CPU(memory);
-		gpu = new GPU(cpu, memory, screen);
-		joypad = new Joypad(memory, cpu);
-	
-		// Reset frame limiter vars
-		frameStart = high_resolution_clock::now();
-		timeBalance = 0;
-		shouldSleep = false;
-	
-		#ifdef _WIN32
-		timeBeginPeriod(1);
-		#endif
-		
-		log = new std::ofstream("log.txt");
 	
-		// Reset all devices
-		Reset();
-		// Enter game loop
-		Loop();
-	}
+	// Create devices
+	memory = new Memory(cart);
+	cpu = new CPU(memory, &debug);
+	gpu = new GPU(cpu, memory, screen);
+	joypad = new Joypad(memory, cpu);
+	serial = new Serial(memory, cpu);
+	apu = new APU(memory, cpu);
+	
+	serial->SetSink(serialSink);
+	apu->SetSink(audioSink, sampleRate);
+	gpu->SetFrameHashSink(frameHashSink);
+	joypad->SetInputQueue(inputQueue);
+	gpu->SetFrameSkip(frameSkip);
+	gpu->SetThreadedRendering(threadedRendering);
+	
+	// Reset all devices
+	Reset();
+	
+	return true;
+}
+
+void GameBoy::Unload()
+{
+	// GPU first (stops the render thread)
+	delete gpu;
+	delete joypad;
+	delete serial;
+	delete apu;
+	delete cpu;
+	delete memory;
+	
+	gpu = NULL;
+	joypad = NULL;
+	serial = NULL;
+	apu = NULL;
+	cpu = NULL;
+	memory = NULL;
+	
+	// Its size depends on the cart
+	AlignedFree(stateBuffer);
+	stateBuffer = NULL;
 }
 
 void GameBoy::Reset()
 {
+	memory->cart->Reset();
 	memory->Reset();
 	cpu->Reset();
 	gpu->Reset();
 	joypad->Reset();
+	serial->Reset();
+	apu->Reset();
 	
 	ly = &memory->io[0x44];
+	
+	screen->MarkAllDirty();
+}
+
+int GameBoy::GetStateRegions(StateRegion* regions)
+{
+	bool isCGB = memory->cart->isCGB;
+	
+	// DMG only has 1 bank of VRAM and 2 of WRAM
+	regions[0].data = memory->ram;
+	regions[0].size = (isCGB)? 0x8000 : 0x2000;
+	regions[1].data = memory->vram;
+	regions[1].size = (isCGB)? 0x4000 : 0x2000;
+	regions[2].data = memory->oam;
+	regions[2].size = 0xA0;
+	// With HRAM and IE
+	regions[3].data = memory->io;
+	regions[3].size = 0x100;
+	regions[4].data = memory->cart->GetRAM();
+	regions[4].size = memory->cart->GetRAMSize();
+	
+	return 5;
+}
+
+size_t GameBoy::GetRawStateSize()
+{
+	StateRegion regions[5];
+	int count = GetStateRegions(regions);
+	
+	size_t size = sizeof(StateBlock);
+	for (int i = 0; i < count; i++)
+		size += regions[i].size;
+	
+	return size;
+}
+
+uint8_t* GameBoy::GetStateBuffer()
+{
+	if (!stateBuffer)
+		stateBuffer = (uint8_t*)AlignedAlloc(GetRawStateSize());
+	
+	return stateBuffer;
 }
 
-void Wait()
+size_t GameBoy::GetStateSize()
 {
-	#ifdef _WIN32
-		//timeBeginPeriod(1);
-		Sleep(1);
-	#else
-		printf("UH NO");
-	#endif
+	if (!memory)
+		return 0;
+	
+	size_t size = GetRawStateSize();
+	
+#ifdef BETTERGB_LZ4
+	// Data that doesn't compress grows a little
+	size = LZ4_compressBound(size);
+#endif
+	
+	return sizeof(SaveStateHeader) + size;
+}
+
+size_t GameBoy::SaveState(uint8_t* buffer, size_t size, bool compress)
+{
+	if (!memory || size < sizeof(SaveStateHeader))
+		return 0;
+	
+	SaveStateHeader header;
+	header.magic = SAVESTATE_MAGIC;
+	header.version = SAVESTATE_VERSION;
+	header.flags = (memory->cart->isCGB)? SAVESTATE_CGB : 0;
+	header.romCheck = romCheck;
+	header.size = GetRawStateSize();
+	header.packedSize = header.size;
+	
+#ifndef BETTERGB_LZ4
+	compress = false;
+#endif
+	
+	// Uncompressed states are written straight to the buffer
+	uint8_t* data = buffer + sizeof(SaveStateHeader);
+	
+	if (compress)
+		data = GetStateBuffer();
+	else if (size - sizeof(SaveStateHeader) < header.size)
+		return 0;
+	
+	// Zeroed so the padding is the same in every state (for diffing)
+	StateBlock block;
+	memset(&block, 0, sizeof(block));
+	
+	cpu->SaveState(&block.cpu);
+	gpu->SaveState(&block.gpu);
+	memory->SaveState(&block.memory);
+	joypad->SaveState(&block.joypad);
+	serial->SaveState(&block.serial);
+	apu->SaveState(&block.apu);
+	memory->cart->SaveState(&block.cart);
+	
+	memcpy(data, &block, sizeof(block));
+	uint8_t* out = data + sizeof(block);
+	
+	StateRegion regions[5];
+	int count = GetStateRegions(regions);
+	
+	for (int i = 0; i < count; i++)
+	{
+		memcpy(out, regions[i].data, regions[i].size);
+		out += regions[i].size;
+	}
+	
+#ifdef BETTERGB_LZ4
+	if (compress)
+	{
+		size_t capacity = size - sizeof(SaveStateHeader);
+		int packedSize = LZ4_compress_default((const char*)data, (char*)buffer + sizeof(SaveStateHeader),
+			header.size, (capacity > 0x7FFFFFFF)? 0x7FFFFFFF : (int)capacity);
+		
+		if (packedSize <= 0)
+			return 0;
+		
+		header.flags |= SAVESTATE_LZ4;
+		header.packedSize = packedSize;
+	}
+#endif
+	
+	memcpy(buffer, &header, sizeof(header));
+	
+	return sizeof(header) + header.packedSize;
 }
 
-void GameBoy::Loop()
+bool GameBoy::LoadState(const uint8_t* buffer, size_t size)
 {
-	bool quit = false;
-	clock_t cpuTime, gpuTime, eventsTime, screenTime;
-	high_resolution_clock::time_point frameTime;
-	float frameTimeInSecs;
+	if (!memory || size < sizeof(SaveStateHeader))
+		return false;
+	
+	SaveStateHeader header;
+	memcpy(&header, buffer, sizeof(header));
+	
+	uint32_t cgbFlag = (memory->cart->isCGB)? SAVESTATE_CGB : 0;
+	
+	if (header.magic != SAVESTATE_MAGIC || header.version != SAVESTATE_VERSION ||
+		header.romCheck != romCheck || (header.flags & SAVESTATE_CGB) != cgbFlag ||
+		header.size != GetRawStateSize() || header.packedSize > size - sizeof(header))
+		return false;
+	
+	const uint8_t* data = buffer + sizeof(header);
 	
-	while (!quit)
+	if (header.flags & SAVESTATE_LZ4)
 	{
-		// Step events are called every cycle
-		cpuTime = clock();
-		cpu->Step();
-		cpuTime = clock() - cpuTime;
+#ifdef BETTERGB_LZ4
+		uint8_t* unpacked = GetStateBuffer();
 		
-		gpuTime = clock();
-		gpu->Step();
-		gpuTime = clock() - gpuTime;
-				
-		// If a frame has just finished
-		if (*ly == 0)
-		{
-			// If should sleep
-			if (shouldSleep)
-			{
-				// Called once per frame
-				// Handle SDL Events
-				eventsTime = clock();
-				quit = HandleEvents();
-				eventsTime = clock() - eventsTime;
-
-				// Draw screen
-				screenTime = clock();
-				screen->Draw();
-				screenTime = clock() - screenTime;
-				
-				// Calculate frame time
-				frameTime = high_resolution_clock::now();
-				frameTimeInSecs = duration_cast<microseconds>(frameTime - frameStart).count() / 1000000.0;
-				
-				// While we have not reached the desired frame time
-				while (frameTimeInSecs < (DESIRED_FRAME_TIME - timeBalance))
-				{
-					// wait for 1ms
-					SDL_Delay(1);
-					
-					// Calculate frame time
-					frameTime = high_resolution_clock::now();
-					frameTimeInSecs = duration_cast<microseconds>(frameTime - frameStart).count() / 1000000.0;
-				}
-				
-				if (FRAMELIMITER_DEBUG)
-				{
-					printf("CPU   : %f ms\n", ((float)cpuTime) / CLOCKS_PER_SEC);
-					printf("GPU   : %f ms\n", ((float)gpuTime) / CLOCKS_PER_SEC);
-					printf("EVENTS: %f ms\n", ((float)eventsTime) / CLOCKS_PER_SEC);
-					printf("SCREEN: %f ms\n", ((float)screenTime) / CLOCKS_PER_SEC);
-					
-					printf("TOTAL : %f ms\n", ((float)(cpuTime + gpuTime + eventsTime + screenTime)) / CLOCKS_PER_SEC);
-					printf("DESIRED: %f ms, GOT: %f ms\n\n", DESIRED_FRAME_TIME - timeBalance, frameTimeInSecs);
-				}
-				
-				// Calculate new time balance (time vs actual time)
-				timeBalance = frameTimeInSecs - (DESIRED_FRAME_TIME - timeBalance);
-				
-				// Record new frame start time
-				frameStart = high_resolution_clock::now();;
-				
-				// Don't sleep again this frame
-				shouldSleep = false;
-			}
-		}
-		else
-		{
-			// Reset for next frame
-			shouldSleep = true;
-		}
+		if (LZ4_decompress_safe((const char*)data, (char*)unpacked, header.packedSize, header.size) != (int)header.size)
+			return false;
+		
+		data = unpacked;
+#else
+		return false;
+#endif
+	}
+	else if (header.packedSize != header.size)
+	{
+		return false;
 	}
 	
-	#ifdef _WIN32
-		timeEndPeriod(1);
-	#endif
+	StateBlock block;
+	memcpy(&block, data, sizeof(block));
+	const uint8_t* in = data + sizeof(block);
 	
-	log->flush();
-	log->close();
+	StateRegion regions[5];
+	int count = GetStateRegions(regions);
 	
-	SDL_Quit();		
+	for (int i = 0; i < count; i++)
+	{
+		// Lines over unchanged VRAM/OAM don't have to be redrawn
+		if (regions[i].data == memory->vram)
+			gpu->OnVRAMLoad(in, regions[i].size);
+		else if (regions[i].data == memory->oam)
+			gpu->OnOAMLoad(in);
+		
+		memcpy(regions[i].data, in, regions[i].size);
+		in += regions[i].size;
+	}
+	
+	// Memory before the GPU (it gives the render thread the new VRAM)
+	cpu->LoadState(&block.cpu);
+	memory->LoadState(&block.memory);
+	gpu->LoadState(&block.gpu);
+	joypad->LoadState(&block.joypad);
+	serial->LoadState(&block.serial);
+	apu->LoadState(&block.apu);
+	memory->cart->LoadState(&block.cart);
+	
+	// The screen isn't part of the state, so its dirty lines are left as
+	// they were (run-ahead loads a state every frame)
+	return true;
 }
 
-bool GameBoy::HandleEvents()
+void GameBoy::Step()
 {
-	SDL_Event e;
+	cpu->Step();
+	gpu->Step();
+	serial->Step();
+}
+
+void GameBoy::RunFrame()
+{
+	// Finish line 0 if the frame just started, then run until LY wraps
+	while (*ly == 0)
+		Step();
+	
+	while (*ly != 0)
+		Step();
 	
-	while (SDL_PollEvent(&e) != 0)
+	joypad->EndFrame();
+	apu->EndFrame();
+}
+
+int GameBoy::RunCycles(int cycles)
+{
+	int ran = 0;
+	
+	while (ran < cycles)
 	{
-		if (e.type == SDL_QUIT)
-		{
-			return true;
-		}
-		else
-		{
-			screen->OnEvent(&e);
-			joypad->OnEvent(&e);
-		}
+		Step();
+		ran += cpu->lastInstructionCycles;
 	}
 	
-	return false;
+	apu->EndFrame();
+	return ran;
+}
+
+void GameBoy::SetInput(uint8_t mask)
+{
+	joypad->SetInput(mask);
+}
+
+void GameBoy::SetSpeculative(bool speculative)
+{
+	apu->SetMuted(speculative);
+	gpu->SetFrameHashSink((speculative)? NULL : frameHashSink);
+	serial->SetSink((speculative)? NULL : serialSink);
+}
+
+void GameBoy::SetInputQueue(InputQueue* queue)
+{
+	inputQueue = queue;
+	
+	if (joypad)
+		joypad->SetInputQueue(queue);
+}
+
+void GameBoy::SetSerialSink(SerialSink* sink)
+{
+	serialSink = sink;
+	
+	if (serial)
+		serial->SetSink(sink);
+}
+
+void GameBoy::SetFrameHashSink(FrameHashSink* sink)
+{
+	frameHashSink = sink;
+	
+	if (gpu)
+		gpu->SetFrameHashSink(sink);
+}
+
+void GameBoy::SetAudioSink(AudioSink* sink, int sampleRate)
+{
+	audioSink = sink;
+	this->sampleRate = sampleRate;
+	
+	if (apu)
+		apu->SetSink(sink, sampleRate);
+}
+
+void GameBoy::SetAudioRate(double sampleRate)
+{
+	if (apu)
+		apu->SetSampleRate(sampleRate);
+}
+
+const uint32_t* GameBoy::GetFramebuffer()
+{
+	// Let the render thread finish first
+	if (gpu)
+		gpu->WaitForRender();
+	
+	return screen->pixels;
+}
+
+Screen* GameBoy::GetScreen()
+{
+	if (gpu)
+		gpu->WaitForRender();
+	
+	return screen;
+}
+
+uint8_t* GameBoy::GetRAM()
+{
+	return memory->ram;
+}
+
+size_t GameBoy::GetRAMSize()
+{
+	return 0x8000;
+}
+
+uint8_t* GameBoy::GetCartRAM()
+{
+	return (memory)? memory->cart->GetRAM() : NULL;
+}
+
+size_t GameBoy::GetCartRAMSize()
+{
+	return (memory)? memory->cart->GetRAMSize() : 0;
+}
+
+Debug* GameBoy::GetDebug()
+{
+	return &debug;
+}
+
+uint64_t GameBoy::GetROMHash()
+{
+	return romHash;
+}
+
+uint64_t GameBoy::GetInstructionCount()
+{
+	return cpu->instructionCount;
+}
+
+void GameBoy::SetFrameSkip(int frameSkip)
+{
+	this->frameSkip = frameSkip;
+	
+	if (gpu)
+		gpu->SetFrameSkip(frameSkip);
+}
+
+int GameBoy::GetFrameSkip()
+{
+	return frameSkip;
+}
+
+void GameBoy::SetThreadedRendering(bool enabled)
+{
+	threadedRendering = enabled;
+	
+	if (gpu)
+		gpu->SetThreadedRendering(enabled);
+}
+
+void GameBoy::RequestFrame()
+{
+	gpu->RequestFrame();
+}
+
+bool GameBoy::IsFrameRendered()
+{
+	return gpu->IsFrameRendered();
 }
\ No newline at end of file
@@ -6,29 +6,125 @@
 #include "memory.h"
 #include "gpu.h"
 #include "joypad.h"
-#include <chrono>
+#include "serial.h"
+#include "apu.h"
+#include "aligned.h"
 
-class GameBoy
+/*
+ * The emulator core.
+ * No SDL or platform code, frontends load a ROM, feed it input,
+ * run it a frame (or some cycles) at a time and show the framebuffer.
+ */
+class GameBoy : public CacheAligned
 {
 	public:
 		GameBoy();
+		~GameBoy();
+		
+		// Loads a ROM (from a file, or copied from memory) and resets
+		// Returns false if the ROM can't be loaded
+		bool LoadROM(const char* filename);
+		bool LoadROM(const uint8_t* data, size_t size);
+		bool IsLoaded();
 		// Resets the gameboy
 		void Reset();
+		
+		// Savestates (see savestate.h)
+		// Bytes a state can take (compressed or not)
+		size_t GetStateSize();
+		// Returns the bytes written, 0 if the buffer is too small
+		// Compression needs LZ4 (BETTERGB_LZ4), otherwise it's ignored
+		size_t SaveState(uint8_t* buffer, size_t size, bool compress = false);
+		// Returns false if the state is from another ROM, build or version
+		bool LoadState(const uint8_t* buffer, size_t size);
+		
+		// Runs until the current frame is finished (LY wraps to 0)
+		void RunFrame();
+		// Runs at least n CPU cycles, returns how many were run
+		int RunCycles(int cycles);
+		
+		// Sets which buttons are held (BUTTON_* mask)
+		void SetInput(uint8_t mask);
+		// Frames run while speculating get thrown away (see RunAhead):
+		// no sound, frame hashes or serial transfers reach the sinks
+		void SetSpeculative(bool speculative);
+		// Button events the game sees as soon as it reads them (NULL = only SetInput)
+		void SetInputQueue(InputQueue* queue);
+		// Connects the serial port (NULL = nothing connected)
+		void SetSerialSink(SerialSink* sink);
+		// Gets a FrameHash after every frame (NULL = no hashing)
+		void SetFrameHashSink(FrameHashSink* sink);
+		// Gets the sound of every frame at sampleRate (NULL = no sound)
+		void SetAudioSink(AudioSink* sink, int sampleRate = 48000);
+		// Nudges the rate samples are made at, without a gap (keeps the
+		// sink's buffer from running dry or filling up)
+		void SetAudioRate(double sampleRate);
+		
+		// 160x144 XRGB8888 pixels
+		const uint32_t* GetFramebuffer();
+		// The LCD (pixels and which lines changed)
+		Screen* GetScreen();
+		// Work RAM (0x8000 bytes, 8 banks of 4KB)
+		uint8_t* GetRAM();
+		size_t GetRAMSize();
+		// Cart RAM (battery saves, kept by Reset; NULL if the cart has none)
+		uint8_t* GetCartRAM();
+		size_t GetCartRAMSize();
+		// FNV-1a hash of the whole ROM (identifies it in movies)
+		uint64_t GetROMHash();
+		// CPU instructions executed since reset
+		uint64_t GetInstructionCount();
+		// Debug switches of this instance
+		Debug* GetDebug();
+		
+		// Drawing options
+		void SetFrameSkip(int frameSkip);
+		int GetFrameSkip();
+		void SetThreadedRendering(bool enabled);
+		// With frame skip 0, draws the frame after the current one
+		void RequestFrame();
+		// If the last finished frame was drawn
+		bool IsFrameRendered();
 	private:
+		// A memory region stored in savestates
+		struct StateRegion
+		{
+			uint8_t* data;
+			size_t size;
+		};
+		
 		Screen* screen;
 		CPU* cpu;
 		Memory* memory;
 		GPU* gpu;
 		Joypad* joypad;
+		Serial* serial;
+		APU* apu;
+		SerialSink* serialSink;
+		FrameHashSink* frameHashSink;
+		AudioSink* audioSink;
+		int sampleRate;
+		InputQueue* inputQueue;
+		Debug debug;
 		
-		// Frame Limiter Variables
 		uint8_t* ly; // LY (current redraw line)
-		std::chrono::high_resolution_clock::time_point frameStart; // Time frame started
-		bool shouldSleep; // Should we sleep
-		float timeBalance; // Excess/Missing time from previous frames
-	
-		void Loop();
-		bool HandleEvents();
+		
+		// Header checksums of the loaded ROM (identifies savestates)
+		uint32_t romCheck;
+		uint64_t romHash;
+		// Uncompressed state (for LZ4), allocated on first use
+		uint8_t* stateBuffer;
+		
+		int frameSkip;
+		bool threadedRendering;
+		
+		bool Load(Cart* cart);
+		void Unload();
+		void Step();
+		
+		int GetStateRegions(StateRegion* regions);
+		size_t GetRawStateSize();
+		uint8_t* GetStateBuffer();
 };
 
 #endif
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "gpu.h"
 #include "memory.h"
+#include "render_thread.h"
+#include "xxhash.h"
 #include <stdio.h>
+#include <string.h>
 #include <iostream>
 
 const int MODE_0_CYCLES = 204;	// HBLANK
@@ -19,27 +22,82 @@ const int FLAG_VBLANK_INTERRUPT = 0x10;
 const int FLAG_OAM_INTERRUPT = 0x20;
 const int FLAG_LYC_ENABLE = 0x40;
 
-bool SPRITE_DEBUG = false;
-extern bool OPCODE_DEBUG;
+const int CGB_BG_BANK = 0x08;
+
+const int VRAM_BANK_SIZE = 0x2000;
 
 class Memory;
 
 using namespace std;
+
+// RGB555 -> ARGB8888 for every CGB color
+struct ColorTable
+{
+	uint32_t colors[0x8000];
+	
+	ColorTable()
+	{
+		for (int i = 0; i < 0x8000; i++)
+		{
+			// Scale 5 bits to 8 bits
+			uint32_t r = i & 0x1F;
+			uint32_t g = (i >> 5) & 0x1F;
+			uint32_t b = (i >> 10) & 0x1F;
+			
+			r = (r << 3) | (r >> 2);
+			g = (g << 3) | (g >> 2);
+			b = (b << 3) | (b >> 2);
+			
+			colors[i] = 0xFF000000 | (r << 16) | (g << 8) | b;
+		}
+	}
+};
+
+static const ColorTable cgbColors;
+
 GPU::GPU(CPU* cpu, Memory* memory, Screen* screen)
 {
 	this->cpu = cpu;
 	this->memory = memory;
 	this->screen = screen;
 	
+	renderer = new Renderer(memory->vram, memory->oam, screen);
+	renderThread = NULL;
+	hashSink = NULL;
+	
+	frameSkip = 1;
+	
 	memory->gpu = this;
 }
 
+GPU::~GPU()
+{
+	SetThreadedRendering(false);
+	delete renderer;
+}
+
 void GPU::Reset()
 {
 	mode = 0;
 	cycleCount = 0;
 	lyCount = 0;
 	
+	frameCounter = 0;
+	frameRequested = false;
+	renderFrame = true;
+	frameRendered = false;
+	
+	// Nothing has been drawn yet, so every line is dirty
+	lineClock = 1;
+	memset(tileStamp, 0, sizeof(tileStamp));
+	memset(mapStamp, 0, sizeof(mapStamp));
+	memset(lineStamp, 0, sizeof(lineStamp));
+	memset(lineDrawn, 0, sizeof(lineDrawn));
+	
+	frameNumber = 0;
+	for (int i = 0; i < 144; i++)
+		lineHashDirty[i] = true;
+	
 	isCGB = memory->cart->isCGB;
 	
 	lcdc	= &memory->io[0x40];
@@ -53,41 +111,98 @@ void GPU::Reset()
 	obp1	= &memory->io[0x49];
 	wy		= &memory->io[0x4A];
 	wx		= &memory->io[0x4B];
+	bgpi	= &memory->io[0x68];
+	bgpd	= &memory->io[0x69];
+	obpi	= &memory->io[0x6A];
+	obpd	= &memory->io[0x6B];
+	
+	renderer->Reset(isCGB);
 	
-	for (int i = 0; i < 8; i++)
+	// CGB palettes start out white
+	if (isCGB)
 	{
-		for (int j = 0; j < 4; j++)
+		for (int i = 0; i < 64; i++)
 		{
-			bgPalette[i][j] = 0;
-			objPalette[i][j] = 0;
+			*bgpi = i;
+			*obpi = i;
+			OnBGPD(0xFF);
+			OnOBPD(0xFF);
 		}
+		
+		*bgpi = 0;
+		*obpi = 0;
 	}
+	
+	paletteStamp = 0;
+	
+	// Give the render thread the new VRAM/OAM/palettes
+	if (renderThread)
+		renderThread->Load(memory->vram, memory->oam, renderer, isCGB);
 }	
 
+void GPU::SaveState(State* state)
+{
+	state->mode = mode;
+	state->cycleCount = cycleCount;
+	state->lyCount = lyCount;
+	state->frameNumber = frameNumber;
+	
+	memcpy(state->bgPaletteRAM, bgPaletteRAM, sizeof(bgPaletteRAM));
+	memcpy(state->objPaletteRAM, objPaletteRAM, sizeof(objPaletteRAM));
+	memcpy(state->bgPalette, renderer->bgPalette, sizeof(state->bgPalette));
+	memcpy(state->objPalette, renderer->objPalette, sizeof(state->objPalette));
+}
+
+void GPU::LoadState(const State* state)
+{
+	mode = state->mode;
+	cycleCount = state->cycleCount;
+	lyCount = state->lyCount;
+	frameNumber = state->frameNumber;
+	
+	memcpy(bgPaletteRAM, state->bgPaletteRAM, sizeof(bgPaletteRAM));
+	memcpy(objPaletteRAM, state->objPaletteRAM, sizeof(objPaletteRAM));
+	
+	// Lines drawn with other colors (VRAM/OAM were compared before the load)
+	if (memcmp(renderer->bgPalette, state->bgPalette, sizeof(state->bgPalette)) != 0 ||
+		memcmp(renderer->objPalette, state->objPalette, sizeof(state->objPalette)) != 0)
+		paletteStamp = lineClock;
+	
+	memcpy(renderer->bgPalette, state->bgPalette, sizeof(state->bgPalette));
+	memcpy(renderer->objPalette, state->objPalette, sizeof(state->objPalette));
+	
+	if (renderThread)
+		renderThread->Load(memory->vram, memory->oam, renderer, isCGB);
+}
+
 void GPU::Step()
 {
-	cycleCount += cpu->lastInstructionCycles;
-	lyCount += cpu->lastInstructionCycles;
+	// The GPU runs at the same speed in CGB double speed mode
+	int cycles = cpu->lastInstructionCycles >> cpu->speedShift;
+	
+	cycleCount += cycles;
+	lyCount += cycles;
 	
 	// Keep incrementing LY (VBLANK will reset it)
 	if (lyCount >= LY_CYCLES)
 	{
 		lyCount -= LY_CYCLES;
-		// if not vblank, draw
-		if (*ly < 144)
+		// if not vblank (and this frame isn't skipped), draw
+		// Lines that haven't changed since last drawn are kept
+		if (*ly < 144 && renderFrame && IsLineDirty())
 		{
-			// Draw backgrounds
-			DrawBackground();
+			lineDrawn[*ly] = lineClock;
+			lineRegisters[*ly] = GetLineRegisters();
+			lineHashDirty[*ly] = true;
 			
-			if (*lcdc & 0x20)
-				DrawWindow();
-			
-			// If sprites are enabled, draw sprites
-			if (*lcdc & 0x02)
-				DrawSprites();
+			if (renderThread)
+				renderThread->DrawLine(*ly, lineRegisters[*ly]);
+			else
+				renderer->DrawLine(*ly, lineRegisters[*ly]);
 		}
 		// Increment ly
 		(*ly)++;
+		lineClock++;
 		
 		// LCDC Interrupt (If LY == LYC)
 		if ((*stat & FLAG_LYC_ENABLE) && (*ly == *lyc))
@@ -129,6 +244,7 @@ void GPU::Step()
 				cycleCount -= MODE_1_CYCLES;
 				// Frame is done, reset LY
 				*ly = 0;
+				StartFrame();
 				// Go to mode 2
 				mode = 2;
 				
@@ -160,6 +276,9 @@ void GPU::Step()
 				{
 					RequestInterrupt();
 				}
+				
+				// HBLANK DMA (CGB)
+				memory->OnHBlank();
 			}
 			break;
 	}
@@ -177,6 +296,98 @@ void GPU::StartVBlank()
 	{
 		RequestInterrupt();
 	}
+	
+	// Line 143 is done, fingerprint the frame
+	if (hashSink)
+		SendFrameHash();
+	
+	frameNumber++;
+}
+
+void GPU::SendFrameHash()
+{
+	// The render thread might still be drawing the last lines
+	if (renderThread)
+		renderThread->Wait();
+	
+	// Only lines drawn since the last hash changed
+	for (int line = 0; line < 144; line++)
+	{
+		if (lineHashDirty[line])
+		{
+			lineHash[line] = XXH64(&screen->pixels[line * Screen::WIDTH], Screen::WIDTH * sizeof(uint32_t));
+			lineHashDirty[line] = false;
+		}
+	}
+	
+	FrameHash hash;
+	hash.frame = frameNumber;
+	hash.rendered = renderFrame;
+	hash.screen = XXH64(lineHash, sizeof(lineHash));
+	// HRAM is FF80-FFFE of the IO region
+	hash.ram = XXH64(&memory->io[0x80], 0x7F, XXH64(memory->ram, (isCGB)? 0x8000 : 0x2000));
+	
+	hashSink->OnFrameHash(hash);
+}
+
+void GPU::StartFrame()
+{
+	frameRendered = renderFrame;
+	
+	// Decide if the next frame should be drawn (timing is unaffected)
+	if (frameSkip > 0)
+	{
+		frameCounter = (frameCounter + 1) % frameSkip;
+		renderFrame = (frameCounter == 0);
+	}
+	else
+	{
+		renderFrame = frameRequested;
+	}
+	
+	frameRequested = false;
+}
+
+void GPU::SetThreadedRendering(bool enabled)
+{
+	if (enabled && !renderThread)
+	{
+		renderThread = new RenderThread(screen);
+		renderThread->Load(memory->vram, memory->oam, renderer, isCGB);
+	}
+	else if (!enabled && renderThread)
+	{
+		renderThread->Wait();
+		delete renderThread;
+		renderThread = NULL;
+	}
+}
+
+void GPU::SetFrameHashSink(FrameHashSink* sink)
+{
+	hashSink = sink;
+}
+
+void GPU::WaitForRender()
+{
+	if (renderThread)
+		renderThread->Wait();
+}
+
+void GPU::SetFrameSkip(int frameSkip)
+{
+	this->frameSkip = (frameSkip < 0)? 0 : frameSkip;
+	frameCounter = 0;
+}
+
+void GPU::RequestFrame()
+{
+	frameRequested = true;
+}
+
+bool GPU::IsFrameRendered()
+{
+	return frameRendered;
 }
 
 void GPU::UpdateSTAT()
@@ -203,6 +414,187 @@ void GPU::RequestInterrupt()
 	memory->RequestInterrupt(FLAG_LCD_STAT);
 }
 
+LineRegisters GPU::GetLineRegisters()
+{
+	LineRegisters regs;
+	
+	regs.lcdc = *lcdc;
+	regs.scy = *scy;
+	regs.scx = *scx;
+	regs.wy = *wy;
+	regs.wx = *wx;
+	regs.bgp = *bgp;
+	regs.obp0 = *obp0;
+	regs.obp1 = *obp1;
+	
+	return regs;
+}
+
+bool GPU::IsLineDirty()
+{
+	int line = *ly;
+	uint64_t drawn = lineDrawn[line];
+	
+	// Never drawn, a sprite on this line has moved/changed, or CGB palettes changed
+	if (!drawn || lineStamp[line] > drawn || paletteStamp > drawn)
+		return true;
+	
+	// Scroll, window, palettes or LCDC changed
+	LineRegisters regs = GetLineRegisters();
+	if (memcmp(&regs, &lineRegisters[line], sizeof(LineRegisters)) != 0)
+		return true;
+	
+	// Background tiles under this line (CGB always draws the background)
+	if ((*lcdc & 0x01) || isCGB)
+	{
+		int map = (*lcdc & 0x08)? 1 : 0;
+		int row = ((line + *scy) & 0xFF) >> 3;
+		
+		if (IsMapRowDirty(map, row, *scx >> 3, 21, drawn))
+			return true;
+	}
+	
+	// Window tiles under this line
+	if ((*lcdc & 0x20) && *wx <= 166 && *wy <= line)
+	{
+		int map = (*lcdc & 0x40)? 1 : 0;
+		int row = ((line - *wy) >> 3) & 31;
+		
+		if (IsMapRowDirty(map, row, 0, 21, drawn))
+			return true;
+	}
+	
+	// Tiles of sprites on this line
+	if (*lcdc & 0x02)
+	{
+		bool is8x16 = *lcdc & 0x04;
+		int sprite_height = (is8x16)? 16 : 8;
+		
+		for (int sprite = 0; sprite < 40; sprite++)
+		{
+			int sprite_y = memory->oam[sprite * 4] - 16;
+			
+			if (sprite_y > line || (sprite_y + sprite_height) <= line)
+				continue;
+			
+			int tile_index = memory->oam[sprite * 4 + 2] & (is8x16 ? 0xFE : 0xFF);
+			
+			// CGB sprites can use tiles in VRAM bank 1
+			if (isCGB && (memory->oam[sprite * 4 + 3] & CGB_BG_BANK))
+				tile_index += 384;
+			
+			if (tileStamp[tile_index] > drawn)
+				return true;
+			if (is8x16 && tileStamp[tile_index | 1] > drawn)
+				return true;
+		}
+	}
+	
+	return false;
+}
+
+bool GPU::IsMapRowDirty(int map, int row, int firstX, int count, uint64_t drawn)
+{
+	if (mapStamp[map][row] > drawn)
+		return true;
+	
+	bool signedData = !(*lcdc & 0x10);
+	int rowAddr = (map? 0x1C00 : 0x1800) + (row << 5);
+	
+	for (int i = 0; i < count; i++)
+	{
+		int mapAddr = rowAddr + ((firstX + i) & 31);
+		int tileIndex = memory->vram[mapAddr];
+		// Tiles 0-255 are at 0x8000, signed tiles are relative to 0x9000
+		int tile = (signedData)? 256 + (int8_t)tileIndex : tileIndex;
+		
+		// CGB tiles can be in VRAM bank 1
+		if (isCGB && (memory->vram[VRAM_BANK_SIZE + mapAddr] & CGB_BG_BANK))
+			tile += 384;
+		
+		if (tileStamp[tile] > drawn)
+			return true;
+	}
+	
+	return false;
+}
+
+void GPU::OnVRAMWrite(uint16_t address, int length)
+{
+	// Send the changes to the render thread's copy
+	if (renderThread)
+	{
+		for (int i = 0; i < length; i++)
+			renderThread->WriteVRAM(address + i, memory->vram[address + i]);
+	}
+	
+	// Writes never cross a tile or map row (up to 16 aligned bytes)
+	MarkVRAM(address);
+}
+
+void GPU::OnVRAMLoad(const uint8_t* data, int size)
+{
+	// 16 byte blocks are a tile or half a map row
+	for (int address = 0; address < size; address += 16)
+	{
+		if (memcmp(memory->vram + address, data + address, 16) != 0)
+			MarkVRAM(address);
+	}
+}
+
+void GPU::OnOAMLoad(const uint8_t* data)
+{
+	for (int sprite = 0; sprite < 0xA0; sprite += 4)
+	{
+		if (memcmp(memory->oam + sprite, data + sprite, 4) != 0)
+		{
+			MarkSpriteLines(memory->oam[sprite] - 16);
+			MarkSpriteLines(data[sprite] - 16);
+		}
+	}
+}
+
+void GPU::MarkVRAM(int address)
+{
+	int bank = address / VRAM_BANK_SIZE;
+	address %= VRAM_BANK_SIZE;
+	
+	if (address < 0x1800)
+	{
+		// Tile data (16 bytes per tile, 384 tiles per bank)
+		tileStamp[bank * 384 + (address >> 4)] = lineClock;
+	}
+	else
+	{
+		// Tile maps or CGB attributes (32 bytes per row, 2 maps)
+		mapStamp[(address >> 10) & 1][(address >> 5) & 31] = lineClock;
+	}
+}
+
+void GPU::OnOAMWrite(uint16_t address, uint8_t oldData)
+{
+	int sprite_index = address & ~0x03;
+	
+	if (renderThread)
+		renderThread->WriteOAM(address, memory->oam[address]);
+	
+	// The sprite is gone from the lines it used to be on
+	if (address == sprite_index)
+		MarkSpriteLines(oldData - 16);
+	
+	MarkSpriteLines(memory->oam[sprite_index] - 16);
+}
+
+void GPU::MarkSpriteLines(int y)
+{
+	// Sprites can be up to 16 lines tall
+	for (int line = y; line < y + 16; line++)
+	{
+		if (line >= 0 && line < 144)
+			lineStamp[line] = lineClock;
+	}
+}
+
 uint32_t GetShade(uint8_t num)
 {
 	switch (num)
@@ -239,235 +631,92 @@ void GPU::OnSTAT(uint8_t data)
 
 void GPU::OnBGP(uint8_t data)
 {
-	bgPalette[0][0] = GetShade(data & 0x03);
-	bgPalette[0][1] = GetShade((data & 0x0C) >> 2);
-	bgPalette[0][2] = GetShade((data & 0x30) >> 4);
-	bgPalette[0][3] = GetShade((data & 0xC0) >> 6);
-	
 	*bgp = data;
+	
+	// CGB uses palette RAM instead
+	if (isCGB)
+		return;
+	
+	SetColor(false, 0, 0, GetShade(data & 0x03));
+	SetColor(false, 0, 1, GetShade((data & 0x0C) >> 2));
+	SetColor(false, 0, 2, GetShade((data & 0x30) >> 4));
+	SetColor(false, 0, 3, GetShade((data & 0xC0) >> 6));
 }
 
 void GPU::OnOBP0(uint8_t data)
 {
-	objPalette[0][1] = GetShade((data & 0x0C) >> 2);
-	objPalette[0][2] = GetShade((data & 0x30) >> 4);
-	objPalette[0][3] = GetShade((data & 0xC0) >> 6);
-	
 	*obp0 = data;
+	
+	if (isCGB)
+		return;
+	
+	SetColor(true, 0, 1, GetShade((data & 0x0C) >> 2));
+	SetColor(true, 0, 2, GetShade((data & 0x30) >> 4));
+	SetColor(true, 0, 3, GetShade((data & 0xC0) >> 6));
 }
 
 void GPU::OnOBP1(uint8_t data)
 {
-	objPalette[1][1] = GetShade((data & 0x0C) >> 2);
-	objPalette[1][2] = GetShade((data & 0x30) >> 4);
-	objPalette[1][3] = GetShade((data & 0xC0) >> 6);
-	
 	*obp1 = data;
+	
+	if (isCGB)
+		return;
+	
+	SetColor(true, 1, 1, GetShade((data & 0x0C) >> 2));
+	SetColor(true, 1, 2, GetShade((data & 0x30) >> 4));
+	SetColor(true, 1, 3, GetShade((data & 0xC0) >> 6));
 }
 
 // CGB
 void GPU::OnBGPI(uint8_t data)
 {
-	
+	*bgpi = data | 0x40;
+	*bgpd = bgPaletteRAM[data & 0x3F];
 }
 
 void GPU::OnBGPD(uint8_t data)
 {
-	
+	WritePaletteRAM(bgPaletteRAM, false, bgpi, data);
+	*bgpd = bgPaletteRAM[*bgpi & 0x3F];
 }
 
 void GPU::OnOBPI(uint8_t data)
 {
-	
+	*obpi = data | 0x40;
+	*obpd = objPaletteRAM[data & 0x3F];
 }
 
 void GPU::OnOBPD(uint8_t data)
 {
-
+	WritePaletteRAM(objPaletteRAM, true, obpi, data);
+	*obpd = objPaletteRAM[*obpi & 0x3F];
 }
 
-void GPU::DrawBackground()
+void GPU::SetColor(bool isObj, int palette, int color, uint32_t argb)
 {
-	// If the background should be shown, or all white
-	bool showBackground = *lcdc & 0x01;
-	// Find which tile map to use (depending on LCDC)
-	int dataAddr = (*lcdc & 0x10)? 0x0000 : 0x1000;
-	int bgMapAddr = (*lcdc & 0x08)? 0x1C00: 0x1800;
-	
-	// Calculate Y (y + scrollY % 256)
-	int wrappedY = (*ly + *scy) & 0xFF;
-	// Get Y on map
-	int mapY = wrappedY / 8;
-	// Get Y in tile (wrappedY % 8)
-	int tileY = wrappedY & 7;
-	
-	// If background is disabled, fill with white
-	if (!showBackground)
-	{
-		for (int x = 0; x < 160; x++)
-		{
-			screen->SetPixel(x, *ly, 0xFFFFFFFF);
-			bg_mask[x][*ly] = 0;
-		}
-		
-		return;
-	}
+	if (isObj)
+		renderer->objPalette[palette][color] = argb;
+	else
+		renderer->bgPalette[palette][color] = argb;
 	
-	// Otherwise, draw backgrounds
-	for (int x = 0; x < 160; x++)
-	{
-		// Calculate X (x + scrollX % 256)
-		uint32_t wrappedX = (x + *scx) & 0xFF;
-		// Get X on map
-		int mapX = wrappedX / 8;
-		// Get tile x (wrappedX % 8)
-		int tileX = wrappedX & 7;
-		
-		// Map Tile = Map Base Addr + (y * 32) + x
-		// 32 is map width
-		int tileIndex = memory->vram[bgMapAddr + (mapY << 5) + mapX];
-		// If using the second Tile Data area, convert to signed char
-		if (dataAddr == 0x1000) tileIndex = (int8_t)tileIndex;
-		
-		// Line = 2 bytes @ DataBaseAddr + (tileIndex * tileSize) + (tileY * lineSize)
-		int lsb = memory->vram[dataAddr + tileIndex * 16 + tileY * 2];
-		int msb = memory->vram[dataAddr + tileIndex * 16 + tileY * 2 + 1];
-		
-		// Calculate color index
-		int color_index;;
-		color_index =  (lsb & (0x80 >> tileX))? 0x1 : 0x0;
-		color_index += (msb & (0x80 >> tileX))? 0x2 : 0x0;
-		
-		// Draw pixel
-		//if (!bg_mask[x][*ly])
-			screen->SetPixel(x, *ly, bgPalette[0][color_index]);
-		
-		// If color == 0, then is 'transparent'
-		bg_mask[x][*ly] = color_index? 1 : 0;
-	}
+	if (renderThread)
+		renderThread->SetColor(isObj, palette, color, argb);
 }
 
-void GPU::DrawSprites()
+void GPU::WritePaletteRAM(uint8_t* paletteRAM, bool isObj, uint8_t* index, uint8_t data)
 {
-	// LCDC Attributes
-	bool is8x16 = *lcdc & 0x04;
-	
-	// Calculate sprite height
-	int sprite_height = (is8x16)? 16 : 8;
-	
-	for (int sprite = 39; sprite >= 0; sprite--)
-	{
-		int sprite_index = sprite * 4;
-		
-		// Get Y
-		int sprite_y = memory->oam[sprite_index] - 16;
-		
-		// If not on line, skip
-		if (sprite_y > *ly || (sprite_y + sprite_height) <= *ly)
-			continue;
-		
-		// Get X
-		int sprite_x = memory->oam[sprite_index + 1] - 8;
-		
-		// If not on screen, skip
-		if (sprite_x == -8 || sprite_x >= 160)
-			continue;
-		
-		// Get tile index
-		int tile_index = memory->oam[sprite_index + 2] & (is8x16 ? 0xFE : 0xFF);
-		// Get sprite attributes
-		int sprite_attributes = memory->oam[sprite_index + 3];
-		
-		bool x_flip = sprite_attributes & 0x20;
-		bool y_flip = sprite_attributes & 0x40;
-		int palette = (sprite_attributes & 0x10) >> 4;//(isCGB)? sprite_attributes & 0x07;
-		bool behind_bg = sprite_attributes & 0x80;
-		
-		int tile_y = *ly - sprite_y;
-		
-		if (y_flip)
-		{
-			tile_y = ((is8x16)? 15 : 7) - tile_y;
-		}
-		
-		if (tile_y >= 8)
-		{
-			tile_index |= 1;
-			tile_y -= 8;
-		}
-
-		// Get the tile line
-		int lsb, msb;
-		lsb = memory->vram[tile_index * 16 + tile_y * 2];
-		msb = memory->vram[tile_index * 16 + tile_y * 2 + 1];
-		
-		// Calculate sprite X bounds
-		int start = (sprite_x < 0)? 0 - sprite_x : 0;
-		int end = (sprite_x + 7 >= 160)? 160 - sprite_x : 8;
-		
-		for (int tile_x = start; tile_x < end; tile_x++)
-		{
-			int color_index;
-			color_index =  (lsb & (0x01 << (x_flip? tile_x : (7 - tile_x))))? 0x1 : 0x0;
-			color_index += (msb & (0x01 << (x_flip? tile_x : (7 - tile_x))))? 0x2 : 0x0;
-			
-			int bg_mode = bg_mask[sprite_x + tile_x][*ly];
-			
-			// If not transparent, draw
-			if (color_index && (!behind_bg || bg_mode == 0))
-			{
-				screen->SetPixel(sprite_x + tile_x, *ly, objPalette[palette][color_index]);
-			}
-		}
-	}
-}
-
-void GPU::DrawWindow()
-{	
-	if (*wx > 166 || *wy > 143 || *wy > *ly)
-		return;
-	
-	//printf("X %d Y %d \n", *wx, *wy);
+	int address = *index & 0x3F;
 	
-	// Find which tile map to use (depending on LCDC)
-	int dataAddr = (*lcdc & 0x10)? 0x0000 : 0x1000;
-	int bgMapAddr = (*lcdc & 0x40)? 0x1C00: 0x1800;
+	paletteRAM[address] = data;
 	
-	//printf("%d\n", *wy);
+	// Update the ARGB color this byte belongs to (2 bytes per color, 4 colors per palette)
+	int color = address >> 1;
+	int rgb555 = (paletteRAM[color << 1] | (paletteRAM[(color << 1) | 1] << 8)) & 0x7FFF;
+	SetColor(isObj, color >> 2, color & 0x03, cgbColors.colors[rgb555]);
 	
-	// Calculate Y (y + scrollY % 256)
-	int wrappedY = (*ly - *wy);
-	// Get Y on map
-	int mapY = wrappedY / 8;
-	// Get Y in tile (wrappedY % 8)
-	int tileY = wrappedY & 7;
+	// Auto increment
+	if (*index & 0x80)
+		*index = (*index & 0xC0) | ((address + 1) & 0x3F);
 	
-	// Otherwise, draw backgrounds
-	for (int x = *wx - 7; x < 160; x++)
-	{
-		// Get X on map
-		int mapX = x / 8;
-		// Get tile x (wrappedX % 8)
-		int tileX = x & 7;
-		
-		// Map Tile = Map Base Addr + (y * 32) + x
-		// 32 is map width
-		int tileIndex = memory->vram[bgMapAddr + (mapY << 5) + mapX];
-		// If using the second Tile Data area, convert to signed char
-		if (dataAddr == 0x1000) tileIndex = (int8_t)tileIndex;
-		
-		// Line = 2 bytes @ DataBaseAddr + (tileIndex * tileSize) + (tileY * lineSize)
-		int lsb = memory->vram[dataAddr + tileIndex * 16 + tileY * 2];
-		int msb = memory->vram[dataAddr + tileIndex * 16 + tileY * 2 + 1];
-		
-		// Calculate color index
-		int color_index;;
-		color_index =  (lsb & (0x80 >> tileX))? 0x1 : 0x0;
-		color_index += (msb & (0x80 >> tileX))? 0x2 : 0x0;
-		
-		bg_mask[x][*ly] = color_index? 1 : 0;
-		
-		// Draw pixel
-		screen->SetPixel(x, *ly, bgPalette[0][color_index]);
-	}
+	paletteStamp = lineClock;
 }
\ No newline at end of file
@@ -3,16 +3,60 @@
 
 #include "cpu.h"
 #include "screen.h"
+#include "renderer.h"
+#include "frame_hash.h"
+#include "aligned.h"
 
 class Memory;
+class RenderThread;
 
-class GPU
+class GPU : public CacheAligned
 {
 	public:
+		// Savestate block (plain data, see savestate.h)
+		// Frame skip and dirty tracking aren't saved, after a load only
+		// lines over what the load changed are redrawn
+		struct State
+		{
+			int32_t mode;
+			int32_t cycleCount;
+			int32_t lyCount;
+			// Frame hashes keep counting from here
+			uint32_t frameNumber;
+			uint8_t bgPaletteRAM[64];
+			uint8_t objPaletteRAM[64];
+			uint32_t bgPalette[8][4];
+			uint32_t objPalette[8][4];
+		};
+		
 		GPU(CPU* cpu, Memory* memory, Screen* screen);
+		~GPU();
 		
 		void Reset();
 		void Step();
+		void SaveState(State* state);
+		// Load memory first (the render thread copies VRAM/OAM)
+		void LoadState(const State* state);
+		
+		// Frame skip (render 1 of N frames, 0 = only render on request)
+		void SetFrameSkip(int frameSkip);
+		void RequestFrame();
+		bool IsFrameRendered();
+		
+		// Draw lines on a worker thread
+		void SetThreadedRendering(bool enabled);
+		// Waits until all finished lines are drawn
+		void WaitForRender();
+		
+		// Gets a FrameHash every VBLANK (NULL = don't hash)
+		void SetFrameHashSink(FrameHashSink* sink);
+		
+		// Dirty tracking (called by memory when VRAM/OAM changes)
+		void OnVRAMWrite(uint16_t address, int length = 1);
+		void OnOAMWrite(uint16_t address, uint8_t oldData);
+		// Before a savestate overwrites VRAM/OAM, only what differs gets redrawn
+		void OnVRAMLoad(const uint8_t* data, int size);
+		void OnOAMLoad(const uint8_t* data);
 		
 		//
 		void OnSTAT(uint8_t data);
@@ -33,6 +77,10 @@ class GPU
 		Memory* memory;
 		Screen* screen;
 		
+		// Draws lines (inline, or on the render thread)
+		Renderer* renderer;
+		RenderThread* renderThread;
+		
 		// If the screen is enabled
 		bool enabled;
 		// The mode the GPU is currently in
@@ -44,26 +92,54 @@ class GPU
 		int cycleCount;
 		int lyCount;
 		
+		// Frame skip
+		int frameSkip;
+		int frameCounter;
+		bool frameRequested;
+		bool renderFrame; // If the current frame is being drawn
+		bool frameRendered; // If the last finished frame was drawn
+		
 		// Memory references
 		uint8_t *lcdc, *stat;
 		uint8_t *ly, *lyc;
 		uint8_t *scy, *scx, *wy, *wx;
 		uint8_t *bgp, *obp0, *obp1;
+		uint8_t *bgpi, *bgpd, *obpi, *obpd;
 		
-		// Palettes
-		uint32_t objPalette[8][4];
-		uint32_t bgPalette[8][4];
+		// CGB palette RAM (RGB555, 8 palettes of 4 colors)
+		uint8_t bgPaletteRAM[64];
+		uint8_t objPaletteRAM[64];
 		
-		// Is Clear
-		int bg_mask[160][144];
+		// Frame hashes (lines drawn since they were last hashed)
+		FrameHashSink* hashSink;
+		uint32_t frameNumber;
+		uint64_t lineHash[144];
+		bool lineHashDirty[144];
+		
+		// Dirty tracking, stamps are the lineClock of the last change
+		uint64_t lineClock;
+		uint64_t tileStamp[768];
+		uint64_t mapStamp[2][32];
+		uint64_t lineStamp[144];
+		uint64_t paletteStamp;
+		// lineClock when each line was last drawn (0 = never)
+		uint64_t lineDrawn[144];
+		LineRegisters lineRegisters[144];
 		
 		void StartVBlank();
+		void StartFrame();
+		void SendFrameHash();
 		void UpdateSTAT();
 		void RequestInterrupt();
 		
-		void DrawBackground();
-		void DrawSprites();
-		void DrawWindow();
+		LineRegisters GetLineRegisters();
+		bool IsLineDirty();
+		bool IsMapRowDirty(int map, int row, int firstX, int count, uint64_t drawn);
+		void MarkVRAM(int address);
+		void MarkSpriteLines(int y);
+		
+		void SetColor(bool isObj, int palette, int color, uint32_t argb);
+		void WritePaletteRAM(uint8_t* paletteRAM, bool isObj, uint8_t* index, uint8_t data);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "input_queue.h"
+#include <thread>
+
+InputQueue::InputQueue()
+{
+	pending = 0;
+	popped = 0;
+	pushed = 0;
+	held = 0;
+	overflow = 0;
+	hasDeadline = false;
+}
+
+void InputQueue::Push(uint8_t button, bool pressed)
+{
+	if (pressed)
+		held |= button;
+	else
+		held &= ~button;
+	
+	Event event;
+	event.button = button;
+	event.pressed = pressed;
+	
+	// Once it's full, only the latest buttons are kept until a poll
+	// catches up to them
+	if (!overflow.load(std::memory_order_acquire) && events.Push(event))
+		pushed++;
+	else
+		overflow.store((uint64_t)pushed << 16 | OVERFLOWED | held, std::memory_order_release);
+}
+
+bool InputQueue::Apply(uint8_t& mask, uint8_t latched)
+{
+	uint8_t old = mask;
+	Event event;
+	
+	// Held back releases the game has seen the press of by now
+	mask &= ~(pending & ~latched);
+	pending &= latched;
+	
+	// What didn't fit comes after the events that were queued before it
+	// and before the ones queued since (the producer queues again once
+	// it sees this taken)
+	uint64_t latest = overflow.exchange(0, std::memory_order_acq_rel);
+	
+	if (latest)
+	{
+		while (popped != (uint32_t)(latest >> 16) && events.Pop(event))
+		{
+			ApplyEvent(event.button, event.pressed, mask, latched);
+			popped++;
+		}
+		
+		for (int i = 0; i < 8; i++)
+		{
+			uint8_t button = 1 << i;
+			bool down = (mask & button) && !(pending & button);
+			
+			if (((latest & button) != 0) != down)
+				ApplyEvent(button, (latest & button) != 0, mask, latched);
+		}
+	}
+	
+	// In order, so the newest state of each button wins
+	while (events.Pop(event))
+	{
+		ApplyEvent(event.button, event.pressed, mask, latched);
+		popped++;
+	}
+	
+	return mask != old;
+}
+
+void InputQueue::ApplyEvent(uint8_t button, bool pressed, uint8_t& mask, uint8_t& latched)
+{
+	if (pressed)
+	{
+		mask |= button;
+		latched |= button;
+		pending &= ~button;
+	}
+	// The game hasn't had a chance to see the press yet
+	else if (button & latched)
+	{
+		pending |= button;
+	}
+	else
+	{
+		mask &= ~button;
+	}
+}
+
+bool InputQueue::Poll(uint8_t& mask, uint8_t latched)
+{
+	if (hasDeadline)
+	{
+		hasDeadline = false;
+		std::this_thread::sleep_until(deadline);
+	}
+	
+	return Apply(mask, latched);
+}
+
+void InputQueue::SetDeadline(std::chrono::steady_clock::time_point deadline)
+{
+	this->deadline = deadline;
+	hasDeadline = true;
+}
+
+void InputQueue::ClearDeadline()
+{
+	hasDeadline = false;
+}
\ No newline at end of file
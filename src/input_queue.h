@@ -0,0 +1,72 @@
+#ifndef __INPUT_QUEUE__
+#define __INPUT_QUEUE__
+
+#include <stdint.h>
+#include <chrono>
+#include <atomic>
+#include "ring_buffer.h"
+
+/*
+ * Button presses and releases from a frontend thread to the core.
+ * The frontend pushes them as they happen, the joypad applies them
+ * whenever the game reads JOYP (FF00), so a press shows up at the
+ * game's next poll instead of at the next frame.
+ * The release of a button the game hasn't had a chance to see pressed
+ * is held back (see Apply), so a tap that is pressed and released
+ * between two polls isn't lost.
+ * If the game stops polling long enough for the queue to fill up, new
+ * events are folded into the latest held buttons instead of dropped,
+ * the next poll catches up to them.
+ * The first poll after a deadline is set waits for it (once), so a
+ * frontend can have input read as late as possible before the frame
+ * is due.
+ */
+class InputQueue
+{
+	struct Event
+	{
+		uint8_t button;
+		bool pressed;
+	};
+	
+	public:
+		InputQueue();
+		
+		// PRODUCER
+		// A button (BUTTON_*) was pressed or released
+		void Push(uint8_t button, bool pressed);
+		
+		// CONSUMER
+		// Applies what was pushed to a BUTTON_* mask, in order, returns true
+		// if it changed. Releases of latched buttons (and of ones pressed in
+		// the same call) wait until a poll where they aren't latched, the
+		// other buttons' events aren't held up by them
+		bool Apply(uint8_t& mask, uint8_t latched = 0);
+		// Waits for the deadline (if there's one), then applies
+		bool Poll(uint8_t& mask, uint8_t latched = 0);
+		void SetDeadline(std::chrono::steady_clock::time_point deadline);
+		void ClearDeadline();
+		
+	private:
+		RingBuffer<Event, 256> events;
+		// Held back releases (BUTTON_* mask)
+		uint8_t pending;
+		// Events popped (consumer) and pushed (producer) so far
+		uint32_t popped;
+		uint32_t pushed;
+		
+		// Producer's held buttons
+		uint8_t held;
+		// When the queue was full: pushed << 16 | OVERFLOWED | held buttons
+		// (0 = it wasn't)
+		static const uint64_t OVERFLOWED = 0x100;
+		std::atomic<uint64_t> overflow;
+		
+		// Applies a press or release (latched releases go to pending)
+		void ApplyEvent(uint8_t button, bool pressed, uint8_t& mask, uint8_t& latched);
+		
+		bool hasDeadline;
+		std::chrono::steady_clock::time_point deadline;
+};
+
+#endif
\ No newline at end of file
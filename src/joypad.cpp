@@ -2,36 +2,13 @@
 #include "memory.h"
 #include <stdio.h>
 
-const int 
-	DIR_RIGHT = 0,
-	DIR_LEFT = 1,
-	DIR_UP = 2,
-	DIR_DOWN = 3,
-	BUT_A = 4,
-	BUT_B = 5,
-	BUT_SELECT = 6,
-	BUT_START = 7;
 const int FLAG_JOYPAD = 1 << 4;
 
-SDL_Keycode keycodes[8]
-{
-	SDLK_RIGHT,
-	SDLK_LEFT,
-	SDLK_UP,
-	SDLK_DOWN,
-	SDLK_z,
-	SDLK_x,
-	SDLK_a,
-	SDLK_s,
-};
-
-extern bool OPCODE_DEBUG;
-extern bool FRAMELIMITER_DEBUG;
-
 Joypad::Joypad(Memory* memory, CPU* cpu)
 {
 	this->memory = memory;
 	this->cpu = cpu;
+	queue = NULL;
 	
 	memory->joypad = this;
 }
@@ -42,64 +19,91 @@ void Joypad::Reset()
 	
 	for (int i = 0; i < 8; i++)
 		keyState[i] = false;
+	
+	newPresses = 0;
+	lastPresses = 0;
 }
 
-void Joypad::OnEvent(SDL_Event* e)
+void Joypad::SaveState(State* state)
 {
-	if (e->type == SDL_KEYDOWN)
-	{
-		ProcessKeyPress(e->key.keysym.sym, true);
-	}
-	else if (e->type == SDL_KEYUP)
-	{
-		ProcessKeyPress(e->key.keysym.sym, false);
-	}
+	for (int i = 0; i < 8; i++)
+		state->keyState[i] = keyState[i];
 }
 
-void Joypad::ProcessKeyPress(SDL_Keycode key, bool value)
+void Joypad::LoadState(const State* state)
 {
-	if (key == SDLK_F1)
-	{
-		OPCODE_DEBUG = true;
-	}
+	for (int i = 0; i < 8; i++)
+		keyState[i] = state->keyState[i];
 	
-	if (key == SDLK_F2)
+	newPresses = 0;
+	lastPresses = 0;
+}
+
+void Joypad::SetInput(uint8_t mask)
+{
+	for (int i = 0; i < 8; i++)
 	{
-		FRAMELIMITER_DEBUG = true;
+		bool value = (mask >> i) & 1;
+		
+		// Unchanged
+		if (keyState[i] == value)
+			continue;
+		
+		// FIX
+		/*
+		You must set the P1 register ($ff00) in order to do this:
+		P1_REG = $20 ; Cause U,D,L,R to joypad interrupt
+		P1_REG = $10 ; Cause A,B,SELECT,START to joypad interrupt
+		P1_REG = $00 ; Cause any button to joypad interrupt
+		*/
+		// If high->low, request joypad interrupt
+		if (value == true)
+		{
+			memory->RequestInterrupt(FLAG_JOYPAD);
+		}
+		
+		// Set key state
+		keyState[i] = value;
+		
+		// Reset cpu STOP
+		cpu->isStopped = false;
 	}
 	
+	// Update JOYP register
+	UpdateInput();
+}
+
+void Joypad::SetInputQueue(InputQueue* queue)
+{
+	this->queue = queue;
+}
+
+void Joypad::Poll()
+{
+	if (!queue)
+		return;
+	
+	uint8_t mask = 0;
+	
 	for (int i = 0; i < 8; i++)
+		mask |= keyState[i] << i;
+	
+	uint8_t old = mask;
+	
+	// Presses go through SetInput (interrupt, STOP wake up)
+	if (queue->Poll(mask, newPresses | lastPresses))
 	{
-		// If right key
-		if (keycodes[i] == key)
-		{
-			// FIX
-			/*
-			You must set the P1 register ($ff00) in order to do this:
-			P1_REG = $20 ; Cause U,D,L,R to joypad interrupt
-			P1_REG = $10 ; Cause A,B,SELECT,START to joypad interrupt
-			P1_REG = $00 ; Cause any button to joypad interrupt
-			*/
-			// If high->low, request joypad interrupt
-			if (keyState[i] == false && value == true)
-			{
-				memory->RequestInterrupt(FLAG_JOYPAD);
-			}
-			
-			// Set key state
-			keyState[i] = value;
-			
-			// Update JOYP register
-			UpdateInput();
-			
-			// Reset cpu STOP
-			cpu->isStopped = false;
-			
-			break;
-		}
+		newPresses |= mask & ~old;
+		SetInput(mask);
 	}
 }
 
+void Joypad::EndFrame()
+{
+	lastPresses = newPresses;
+	newPresses = 0;
+}
+
 void Joypad::OnJOYP(uint8_t data)
 {
 	*joyp = data;
@@ -2,26 +2,57 @@
 #define __JOYPAD__
 
 #include "cpu.h"
-#include <SDL.h>
+#include "input_queue.h"
+#include "aligned.h"
 
 class Memory;
 
-class Joypad
+// Input mask bits (held buttons)
+const uint8_t BUTTON_RIGHT = 1 << 0;
+const uint8_t BUTTON_LEFT = 1 << 1;
+const uint8_t BUTTON_UP = 1 << 2;
+const uint8_t BUTTON_DOWN = 1 << 3;
+const uint8_t BUTTON_A = 1 << 4;
+const uint8_t BUTTON_B = 1 << 5;
+const uint8_t BUTTON_SELECT = 1 << 6;
+const uint8_t BUTTON_START = 1 << 7;
+
+class Joypad : public CacheAligned
 {
 	public:
+		// Savestate block (plain data, see savestate.h)
+		struct State
+		{
+			bool keyState[8];
+		};
+		
 		Joypad(Memory* memory, CPU* cpu);
 		void Reset();
-		void OnEvent(SDL_Event* event);
+		void SaveState(State* state);
+		void LoadState(const State* state);
+		// Sets which buttons are held (BUTTON_* mask)
+		void SetInput(uint8_t mask);
+		// Button events applied on every JOYP read (NULL = only SetInput)
+		void SetInputQueue(InputQueue* queue);
+		// The game reads JOYP
+		void Poll();
+		// Presses from the queue stay latched through the frame after
+		void EndFrame();
 		void OnJOYP(uint8_t data);
 	
 	private:
 		Memory* memory;
 		CPU* cpu;
+		InputQueue* queue;
 		
 		uint8_t* joyp;	
 		bool keyState[8];
 		
-		void ProcessKeyPress(SDL_Keycode key, bool value);
+		// Buttons the queue pressed this frame and the last one (their
+		// releases wait, the game polls about once a frame)
+		uint8_t newPresses;
+		uint8_t lastPresses;
+		
 		void UpdateInput();
 };
 
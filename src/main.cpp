@@ -1,8 +0,0 @@
-#include "gameboy.h"
-
-int main( int argc, char* args[] )
-{
-	GameBoy();
-	
-	return 0;
-}
\ No newline at end of file
@@ -23,7 +23,7 @@ uint8_t MBC1Cart::ReadROM(uint16_t address)
 		// Calculate bank relative address
 		address = address - ROM_BASE_ADDR;
 				
-		return rom[baseAddress + address];
+		return rom[(baseAddress + address) & (romSize - 1)];
 	}
 }
 
@@ -63,7 +63,6 @@ void MBC1Cart::WriteROM(uint16_t address, uint8_t data)
 
 uint8_t* MBC1Cart::GetROMPtr(uint16_t address)
 {
-	printf("BANK 0x%02x\n", bankNumber);
 	if (address <= 0x3FFF)
 	{
 		return &rom[address];
@@ -77,12 +76,15 @@ uint8_t* MBC1Cart::GetROMPtr(uint16_t address)
 		// Calculate bank relative address
 		address = address - ROM_BASE_ADDR;
 				
-		return &rom[baseAddress + address];
+		return &rom[(baseAddress + address) & (romSize - 1)];
 	}
 }
 
 uint8_t MBC1Cart::ReadRAM(uint16_t address)
 {
+	if (!ram)
+		return 0xFF;
+	
 	if (ramSelect)
 	{
 		int baseAddress;
@@ -92,16 +94,41 @@ uint8_t MBC1Cart::ReadRAM(uint16_t address)
 		// Calculate relative address
 		address = address - RAM_BASE_ADDR;
 		
-		return ram[baseAddress + address];
+		return ram[(baseAddress + address) & (ramSize - 1)];
 	}
 	else
 	{
-		return ram[address - RAM_BASE_ADDR];
+		return ram[(address - RAM_BASE_ADDR) & (ramSize - 1)];
+	}
+}
+
+uint8_t* MBC1Cart::GetRAMPtr(uint16_t address)
+{
+	if (!ram)
+		return NULL;
+	
+	if (ramSelect)
+	{
+		int baseAddress;
+		// Calculate bank
+		baseAddress = (bankNumber >> 5) & 0x03;
+		baseAddress <<= RAM_BANK_SHIFT;
+		// Calculate relative address
+		address = address - RAM_BASE_ADDR;
+		
+		return &ram[(baseAddress + address) & (ramSize - 1)];
+	}
+	else
+	{
+		return &ram[(address - RAM_BASE_ADDR) & (ramSize - 1)];
 	}
 }
 
 void MBC1Cart::WriteRAM(uint16_t address, uint8_t data)
 {
+	if (!ram)
+		return;
+	
 	if (ramSelect)
 	{
 		int baseAddress;
@@ -111,10 +138,28 @@ void MBC1Cart::WriteRAM(uint16_t address, uint8_t data)
 		// Calculate relative address
 		address = address - RAM_BASE_ADDR;
 		
-		ram[baseAddress + address] = data;
+		ram[(baseAddress + address) & (ramSize - 1)] = data;
 	}
 	else
 	{
-		ram[address - RAM_BASE_ADDR] = data;
+		ram[(address - RAM_BASE_ADDR) & (ramSize - 1)] = data;
 	}
 }
+
+void MBC1Cart::Reset()
+{
+	ramSelect = false;
+	bankNumber = 0x01;
+}
+
+void MBC1Cart::SaveState(CartState* state)
+{
+	state->registers[0] = ramSelect;
+	state->registers[1] = bankNumber;
+}
+
+void MBC1Cart::LoadState(const CartState* state)
+{
+	ramSelect = state->registers[0];
+	bankNumber = state->registers[1];
+}
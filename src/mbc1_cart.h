@@ -14,6 +14,10 @@ class MBC1Cart : public Cart
 		uint8_t* GetROMPtr(uint16_t address) override;
 		uint8_t ReadRAM(uint16_t address) override;
 		void WriteRAM(uint16_t address, uint8_t data) override;
+		uint8_t* GetRAMPtr(uint16_t address) override;
+		void Reset() override;
+		void SaveState(CartState* state) override;
+		void LoadState(const CartState* state) override;
 		
 	private:
 		bool ramSelect = false;
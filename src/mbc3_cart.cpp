@@ -0,0 +1,123 @@
+#include "mbc3_cart.h"
+#include <stdio.h>
+
+const int ROM_BASE_ADDR = 0x4000;
+const int RAM_BASE_ADDR = 0xA000;
+const int ROM_BANK_SHIFT = 14;
+const int RAM_BANK_SHIFT = 13;
+const int RTC_FIRST = 0x08;
+const int RTC_LAST = 0x0C;
+
+uint8_t MBC3Cart::ReadROM(uint16_t address)
+{
+	return *GetROMPtr(address);
+}
+
+void MBC3Cart::WriteROM(uint16_t address, uint8_t data)
+{
+	if (address <= 0x1FFF) 
+	{
+		// RAM/RTC Enable
+		ramEnabled = ((data & 0x0F) == 0x0A);
+	}
+	else if (address <= 0x3FFF)
+	{
+		// ROM bank (0 means 1)
+		romBank = data & 0x7F;
+		
+		if (romBank == 0)
+			romBank = 1;
+	}
+	else if (address <= 0x5FFF)
+	{
+		// RAM bank or RTC register
+		ramBank = data & 0x0F;
+	}
+	else
+	{
+		// Latch clock (nothing to latch, the clock doesn't run)
+	}
+}
+
+uint8_t* MBC3Cart::GetROMPtr(uint16_t address)
+{
+	if (address <= 0x3FFF)
+	{
+		return &rom[address];
+	}
+	else
+	{
+		// Calculate bank relative address
+		int baseAddress = romBank << ROM_BANK_SHIFT;
+		address = address - ROM_BASE_ADDR;
+				
+		return &rom[(baseAddress + address) & (romSize - 1)];
+	}
+}
+
+uint8_t MBC3Cart::ReadRAM(uint16_t address)
+{
+	if (!ramEnabled)
+		return 0xFF;
+	
+	if (ramBank >= RTC_FIRST && ramBank <= RTC_LAST)
+		return rtc[ramBank - RTC_FIRST];
+	
+	uint8_t* ptr = GetRAMPtr(address);
+	return (ptr)? *ptr : 0xFF;
+}
+
+void MBC3Cart::WriteRAM(uint16_t address, uint8_t data)
+{
+	if (!ramEnabled)
+		return;
+	
+	if (ramBank >= RTC_FIRST && ramBank <= RTC_LAST)
+	{
+		rtc[ramBank - RTC_FIRST] = data;
+		return;
+	}
+	
+	uint8_t* ptr = GetRAMPtr(address);
+	
+	if (ptr)
+		*ptr = data;
+}
+
+uint8_t* MBC3Cart::GetRAMPtr(uint16_t address)
+{
+	if (!ramEnabled || !ram || ramBank > 0x03)
+		return NULL;
+	
+	return &ram[((ramBank << RAM_BANK_SHIFT) + address - RAM_BASE_ADDR) & (ramSize - 1)];
+}
+
+void MBC3Cart::Reset()
+{
+	ramEnabled = false;
+	romBank = 0x01;
+	ramBank = 0x00;
+	
+	for (int i = 0; i < 5; i++)
+		rtc[i] = 0;
+}
+
+void MBC3Cart::SaveState(CartState* state)
+{
+	state->registers[0] = ramEnabled;
+	state->registers[1] = romBank;
+	state->registers[2] = ramBank;
+	
+	for (int i = 0; i < 5; i++)
+		state->registers[3 + i] = rtc[i];
+}
+
+void MBC3Cart::LoadState(const CartState* state)
+{
+	ramEnabled = state->registers[0];
+	romBank = state->registers[1];
+	ramBank = state->registers[2];
+	
+	for (int i = 0; i < 5; i++)
+		rtc[i] = state->registers[3 + i];
+}
\ No newline at end of file
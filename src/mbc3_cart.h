@@ -0,0 +1,35 @@
+#ifndef __MBC3_CART__
+#define __MBC3_CART__
+
+#include "cart.h"
+
+/*
+ * MBC3 Cart.
+ * 7-bit ROM bank, 4 RAM banks, RTC registers (08-0C) are
+ * readable/writable but the clock doesn't tick.
+ */
+class MBC3Cart : public Cart
+{
+	public:
+		MBC3Cart(int ramSize = 0, bool hasBattery = false) 
+			: Cart(ramSize, hasBattery) {};
+			
+		uint8_t ReadROM(uint16_t address) override;
+		void WriteROM(uint16_t address, uint8_t data) override;
+		uint8_t* GetROMPtr(uint16_t address) override;
+		uint8_t ReadRAM(uint16_t address) override;
+		void WriteRAM(uint16_t address, uint8_t data) override;
+		uint8_t* GetRAMPtr(uint16_t address) override;
+		void Reset() override;
+		void SaveState(CartState* state) override;
+		void LoadState(const CartState* state) override;
+		
+	private:
+		bool ramEnabled = false;
+		uint8_t romBank = 0x01;
+		// 0-3 RAM bank, 8-C RTC register
+		uint8_t ramBank = 0x00;
+		uint8_t rtc[5] = {0};
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "mbc5_cart.h"
+#include <stdio.h>
+
+const int ROM_BASE_ADDR = 0x4000;
+const int RAM_BASE_ADDR = 0xA000;
+const int ROM_BANK_SHIFT = 14;
+const int RAM_BANK_SHIFT = 13;
+
+uint8_t MBC5Cart::ReadROM(uint16_t address)
+{
+	return *GetROMPtr(address);
+}
+
+void MBC5Cart::WriteROM(uint16_t address, uint8_t data)
+{
+	if (address <= 0x1FFF) 
+	{
+		// RAM Enable
+		ramEnabled = ((data & 0x0F) == 0x0A);
+	}
+	else if (address <= 0x2FFF)
+	{
+		// Lower 8 bits of bank number (bank 0 is allowed)
+		romBank = (romBank & 0x100) | data;
+	}
+	else if (address <= 0x3FFF)
+	{
+		// Bit 9 of bank number
+		romBank = (romBank & 0xFF) | ((data & 0x01) << 8);
+	}
+	else if (address <= 0x5FFF)
+	{
+		// RAM bank
+		ramBank = data & 0x0F;
+	}
+}
+
+uint8_t* MBC5Cart::GetROMPtr(uint16_t address)
+{
+	if (address <= 0x3FFF)
+	{
+		return &rom[address];
+	}
+	else
+	{
+		// Calculate bank relative address
+		int baseAddress = romBank << ROM_BANK_SHIFT;
+		address = address - ROM_BASE_ADDR;
+				
+		return &rom[(baseAddress + address) & (romSize - 1)];
+	}
+}
+
+uint8_t MBC5Cart::ReadRAM(uint16_t address)
+{
+	if (!ramEnabled || !ram)
+		return 0xFF;
+	
+	return ram[((ramBank << RAM_BANK_SHIFT) + address - RAM_BASE_ADDR) & (ramSize - 1)];
+}
+
+void MBC5Cart::WriteRAM(uint16_t address, uint8_t data)
+{
+	if (!ramEnabled || !ram)
+		return;
+	
+	ram[((ramBank << RAM_BANK_SHIFT) + address - RAM_BASE_ADDR) & (ramSize - 1)] = data;
+}
+
+uint8_t* MBC5Cart::GetRAMPtr(uint16_t address)
+{
+	if (!ramEnabled || !ram)
+		return NULL;
+	
+	return &ram[((ramBank << RAM_BANK_SHIFT) + address - RAM_BASE_ADDR) & (ramSize - 1)];
+}
+
+void MBC5Cart::Reset()
+{
+	ramEnabled = false;
+	romBank = 0x01;
+	ramBank = 0x00;
+}
+
+void MBC5Cart::SaveState(CartState* state)
+{
+	state->registers[0] = ramEnabled;
+	state->registers[1] = romBank & 0xFF;
+	state->registers[2] = romBank >> 8;
+	state->registers[3] = ramBank;
+}
+
+void MBC5Cart::LoadState(const CartState* state)
+{
+	ramEnabled = state->registers[0];
+	romBank = state->registers[1] | (state->registers[2] << 8);
+	ramBank = state->registers[3];
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef __MBC5_CART__
+#define __MBC5_CART__
+
+#include "cart.h"
+
+class MBC5Cart : public Cart
+{
+	public:
+		MBC5Cart(int ramSize = 0, bool hasBattery = false) 
+			: Cart(ramSize, hasBattery) {};
+			
+		uint8_t ReadROM(uint16_t address) override;
+		void WriteROM(uint16_t address, uint8_t data) override;
+		uint8_t* GetROMPtr(uint16_t address) override;
+		uint8_t ReadRAM(uint16_t address) override;
+		void WriteRAM(uint16_t address, uint8_t data) override;
+		uint8_t* GetRAMPtr(uint16_t address) override;
+		void Reset() override;
+		void SaveState(CartState* state) override;
+		void LoadState(const CartState* state) override;
+		
+	private:
+		bool ramEnabled = false;
+		uint16_t romBank = 0x01;
+		uint8_t ramBank = 0x00;
+};
+
+#endif
\ No newline at end of file
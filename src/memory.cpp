@@ -1,16 +1,14 @@
 #include "memory.h"
 #include "gpu.h"
 #include "joypad.h"
+#include "serial.h"
+#include "apu.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <fstream>
 
-bool MEM_DEBUG;
-extern bool SPRITE_DEBUG;
-extern bool OPCODE_DEBUG;
-extern std::ofstream* log;
-
 class GPU;
 
 using namespace std;
@@ -18,17 +16,28 @@ Memory::Memory(Cart* cart)
 {
 	this->cart = cart;
 	
-	ram 	= (uint8_t*)new unsigned char[0x1007E];
-	vram 	= (uint8_t*)new unsigned char[0x10000];
-	oam 	= (uint8_t*)new unsigned char[0xA0];
-	io 		= (uint8_t*)new unsigned char[0x100];
-	hram 	= (uint8_t*)new unsigned char[0x80];
+	// Each region gets its own cache lines (see aligned.h)
+	ram 	= (uint8_t*)AlignedAlloc(0x8000);
+	vram 	= (uint8_t*)AlignedAlloc(0x4000);
+	oam 	= (uint8_t*)AlignedAlloc(0xA0);
+	// IO registers, HRAM (FF80-FFFE) and IE (FFFF)
+	io 		= (uint8_t*)AlignedAlloc(0x100);
+}
+
+Memory::~Memory()
+{
+	AlignedFree(ram);
+	AlignedFree(vram);
+	AlignedFree(oam);
+	AlignedFree(io);
+	
+	delete cart;
 }
 
 void Memory::Reset()
 {
 	// Reset IO
-	io = (uint8_t*) new unsigned char[0x100]
+	static const uint8_t IO_RESET[0x100] =
 	{
 		0x0F, 0x00, 0x7C, 0xFF, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01,
 		0x80, 0xBF, 0xF3, 0xFF, 0xBF, 0xFF, 0x3F, 0x00, 0xFF, 0xBF, 0x7F, 0xFF, 0x9F, 0xFF, 0xBF, 0xFF,
@@ -48,17 +57,54 @@ void Memory::Reset()
 		0x98, 0xD1, 0x71, 0x02, 0x4D, 0x01, 0xC1, 0xFF, 0x0D, 0x00, 0xD3, 0x05, 0xF9, 0x00, 0x0B, 0x00
 	};
 	
+	memcpy(io, IO_RESET, 0x100);
+	
+	isCGB = cart->isCGB;
+	vramBank = 0x0000;
+	ramBank = 0x1000;
+	
+	hdmaActive = false;
+	hdmaSource = 0;
+	hdmaDest = 0;
+	dmaCycles = 0;
+	
+	// Reset RAM
+	for (int i = 0; i < 0x8000; i++)
+		ram[i] = 0x00;
+	
 	// Reset VRAM
-	for (int i = 0; i < 0x10000; i++)
+	for (int i = 0; i < 0x4000; i++)
 		vram[i] = 0x00;
 	
 	// Reset OAM
 	for (int i = 0; i < 0xA0; i++)
 		oam[i] = 0x00;
+}
+
+void Memory::SaveState(State* state)
+{
+	state->vramBank = vramBank;
+	state->ramBank = ramBank;
+	state->dmaCycles = dmaCycles;
+	state->hdmaSource = hdmaSource;
+	state->hdmaDest = hdmaDest;
+	state->hdmaActive = hdmaActive;
+}
+
+void Memory::LoadState(const State* state)
+{
+	// Masked like the register writes, so a damaged state can't index
+	// outside VRAM/RAM
+	vramBank = state->vramBank & 0x2000;
+	ramBank = state->ramBank & 0x7000;
+	
+	if (!ramBank)
+		ramBank = 0x1000;
 	
-	// Reset IE
-	for (int i = 0; i < 0x80; i++)
-		hram[i] = 0x00;
+	dmaCycles = state->dmaCycles;
+	hdmaSource = state->hdmaSource & 0xFFF0;
+	hdmaDest = state->hdmaDest & 0x1FF0;
+	hdmaActive = state->hdmaActive;
 }
 
 void Memory::RequestInterrupt(uint8_t data)
@@ -74,21 +120,29 @@ uint8_t Memory::ReadByte(uint16_t address)
 	}
 	else if (address <= 0x9FFF)
 	{
-		return vram[address - 0x8000]; // VRAM
+		return vram[vramBank + address - 0x8000]; // VRAM
 	}
 	else if (address <= 0xBFFF)
 	{
 		// EXTERNAL RAM (in Cartridge)
 		return cart->ReadRAM(address);
 	}
-	else if (address <= 0xDFFF)
+	else if (address <= 0xCFFF)
 	{
 		return ram[address - 0xC000]; // RAM
 	}
-	else if (address <= 0xFDFF)
+	else if (address <= 0xDFFF)
+	{
+		return ram[ramBank + address - 0xD000]; // RAM (switchable bank)
+	}
+	else if (address <= 0xEFFF)
 	{
 		return ram[address - 0xE000]; // RAM SHADOW
 	}
+	else if (address <= 0xFDFF)
+	{
+		return ram[ramBank + address - 0xF000]; // RAM SHADOW (switchable bank)
+	}
 	else if (address <= 0xFE9F)
 	{
 		return oam[address - 0xFE00]; // SPRITE OAM
@@ -97,8 +151,16 @@ uint8_t Memory::ReadByte(uint16_t address)
 	{
 		return 0x00;
 	}
+	else if (address >= 0xFF10 && address <= 0xFF3F)
+	{
+		return apu->Read(address); // SOUND
+	}
 	else
 	{
+		// The freshest input (see InputQueue)
+		if (address == 0xFF00)
+			joypad->Poll();
+		
 		return io[address - 0xFF00];
 	}
 }
@@ -120,43 +182,66 @@ void Memory::SetByte(uint16_t address, uint8_t data)
 	}
 	else if (address <= 0x9FFF)
 	{
-		vram[address - 0x8000] = data; // VRAM
+		// VRAM (only changes need to be redrawn)
+		int index = vramBank + address - 0x8000;
+		
+		if (vram[index] != data)
+		{
+			vram[index] = data;
+			gpu->OnVRAMWrite(index);
+		}
 	}
 	else if (address <= 0xBFFF)
 	{
 		cart->WriteRAM(address, data);
 	}
-	else if (address <= 0xDFFF)
+	else if (address <= 0xCFFF)
 	{
 		ram[address - 0xC000] = data; // RAM
 	}
-	else if (address <= 0xFDFF)
+	else if (address <= 0xDFFF)
+	{
+		ram[ramBank + address - 0xD000] = data; // RAM (switchable bank)
+	}
+	else if (address <= 0xEFFF)
 	{
 		ram[address - 0xE000] = data; // RAM SHADOW
 	}
+	else if (address <= 0xFDFF)
+	{
+		ram[ramBank + address - 0xF000] = data; // RAM SHADOW (switchable bank)
+	}
 	else if (address <= 0xFE9F)
 	{
-		oam[address - 0xFE00] = data; // SPRITE OAM
+		WriteOAM(address - 0xFE00, data); // SPRITE OAM
 	}
 	else if (address <= 0xFEFF)
 	{
 	}
+	else if (address >= 0xFF10 && address <= 0xFF3F)
+	{
+		apu->Write(address, data); // SOUND
+	}
 	else
 	{
 		switch (address)
 		{
 			case 0xFF00: joypad->OnJOYP(data); return;
-			//case 0xFF02: if (data == 0x81) cout << io[0x01]; break;
+			case 0xFF02: serial->OnSC(data); return;
 			case 0xFF04: io[0x04] = 0; return; // Reset DIV
 			case 0xFF41: gpu->OnSTAT(data); return;
 			case 0xFF44: io[0x44] = 0; return; // Reset LY
 			case 0xFF47: gpu->OnBGP(data); return;
 			case 0xFF48: gpu->OnOBP0(data); return;
 			case 0xFF49: gpu->OnOBP1(data); return;
+			case 0xFF4D: if (isCGB) io[0x4D] = (io[0x4D] & 0x80) | 0x7E | (data & 0x01); return; // KEY1
+			case 0xFF4F: OnVBK(data); return;
+			case 0xFF55: OnHDMA5(data); return;
 			case 0xFF68: gpu->OnBGPI(data); return;
 			case 0xFF69: gpu->OnBGPD(data); return;
-			case 0xFF6A: gpu->OnBGPI(data); return;
-			case 0xFF6B: gpu->OnBGPI(data); return;
+			case 0xFF6A: gpu->OnOBPI(data); return;
+			case 0xFF6B: gpu->OnOBPD(data); return;
+			case 0xFF70: OnSVBK(data); return;
 			case 0xFF46: CopyToOAM(data << 8); return; // COPY TO OAM
 		};
 		
@@ -167,9 +252,121 @@ void Memory::SetByte(uint16_t address, uint8_t data)
 
 void Memory::CopyToOAM(uint16_t address)
 {
-	for (int i = 0; i < 0x9F; i++)
+	for (int i = 0; i < 0xA0; i++)
+	{
+		WriteOAM(i, ReadByte(address + i));
+	}
+}
+
+void Memory::WriteOAM(uint8_t index, uint8_t data)
+{
+	uint8_t oldData = oam[index];
+	
+	// OAM DMA usually rewrites the same values every frame
+	if (oldData != data)
+	{
+		oam[index] = data;
+		gpu->OnOAMWrite(index, oldData);
+	}
+}
+
+void Memory::OnVBK(uint8_t data)
+{
+	// Only CGB has a second VRAM bank
+	if (isCGB)
+	{
+		vramBank = (data & 0x01) << 13;
+		io[0x4F] = 0xFE | (data & 0x01);
+	}
+}
+
+void Memory::OnSVBK(uint8_t data)
+{
+	// Only CGB has switchable RAM banks (bank 0 selects bank 1)
+	if (isCGB)
+	{
+		int bank = data & 0x07;
+		ramBank = ((bank)? bank : 1) << 12;
+		io[0x70] = 0xF8 | (data & 0x07);
+	}
+}
+
+void Memory::OnHDMA5(uint8_t data)
+{
+	if (!isCGB)
+		return;
+	
+	// Writing bit 7 = 0 during a HBLANK DMA stops it
+	if (hdmaActive && !(data & 0x80))
+	{
+		hdmaActive = false;
+		io[0x55] |= 0x80;
+		return;
+	}
+	
+	hdmaSource = ((io[0x51] << 8) | io[0x52]) & 0xFFF0;
+	hdmaDest = ((io[0x53] << 8) | io[0x54]) & 0x1FF0;
+	// Blocks left - 1
+	io[0x55] = data & 0x7F;
+	
+	if (data & 0x80)
+	{
+		// HBLANK DMA, 16 bytes every HBLANK
+		hdmaActive = true;
+	}
+	else
+	{
+		// General purpose DMA, everything now
+		hdmaActive = true;
+		
+		while (hdmaActive)
+			CopyHDMABlock();
+	}
+}
+
+void Memory::OnHBlank()
+{
+	if (hdmaActive)
+		CopyHDMABlock();
+}
+
+void Memory::CopyHDMABlock()
+{
+	uint8_t block[0x10];
+	uint8_t* source = GetBytePointer(hdmaSource);
+	uint8_t* dest = &vram[vramBank + hdmaDest];
+	
+	// Regions are 16 byte aligned, so a block is never split
+	if (!source)
+	{
+		for (int i = 0; i < 0x10; i++)
+			block[i] = ReadByte(hdmaSource + i);
+		
+		source = block;
+	}
+	
+	// Only changes need to be redrawn
+	if (memcmp(dest, source, 0x10) != 0)
+	{
+		memcpy(dest, source, 0x10);
+		gpu->OnVRAMWrite(vramBank + hdmaDest, 0x10);
+	}
+	
+	hdmaSource += 0x10;
+	hdmaDest = (hdmaDest + 0x10) & 0x1FF0;
+	
+	// 8 microseconds per block, in either speed
+	dmaCycles += (io[0x4D] & 0x80)? 64 : 32;
+	
+	// Count down, 0xFF = done
+	if (io[0x55] == 0x00)
 	{
-		oam[i] = ReadByte(address + i);
+		hdmaActive = false;
+		io[0x55] = 0xFF;
+	}
+	else
+	{
+		io[0x55]--;
 	}
 }
 
@@ -183,29 +380,33 @@ uint8_t* Memory::GetBytePointer(uint16_t address)
 {
 	if (address <= 0x7FFF)
 	{
-		// UHH WHAT
-		printf("ARE YOU STUPID? 0x%04x\n", address);
-		//OPCODE_DEBUG = true;
-		return cart->GetROMPtr(address);
+		return cart->GetROMPtr(address); // ROM
 	}
 	else if (address <= 0x9FFF)
 	{
-		return &vram[address - 0x8000]; // VRAM
+		return &vram[vramBank + address - 0x8000]; // VRAM
 	}
 	else if (address <= 0xBFFF)
 	{
 		// EXTERNAL RAM (in Cartridge)
-		printf("WHY ERAM POINTER...");
-		return NULL;
+		return cart->GetRAMPtr(address);
 	}
-	else if (address <= 0xDFFF)
+	else if (address <= 0xCFFF)
 	{
 		return &ram[address - 0xC000]; // RAM
 	}
-	else if (address <= 0xFDFF)
+	else if (address <= 0xDFFF)
+	{
+		return &ram[ramBank + address - 0xD000]; // RAM (switchable bank)
+	}
+	else if (address <= 0xEFFF)
 	{
 		return &ram[address - 0xE000]; // RAM SHADOW
 	}
+	else if (address <= 0xFDFF)
+	{
+		return &ram[ramBank + address - 0xF000]; // RAM SHADOW (switchable bank)
+	}
 	else if (address <= 0xFE9F)
 	{
 		return &oam[address - 0xFE00]; // SPRITE OAM
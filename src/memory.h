@@ -3,33 +3,56 @@
 
 #include <stdint.h>
 #include "cart.h"
+#include "aligned.h"
 
 class GPU;
 class Joypad;
+class Serial;
+class APU;
 
-class Memory
+class Memory : public CacheAligned
 {
 	public:
+		// Savestate block (plain data, see savestate.h)
+		// The memory regions are saved separately
+		struct State
+		{
+			int32_t vramBank;
+			int32_t ramBank;
+			int32_t dmaCycles;
+			uint16_t hdmaSource;
+			uint16_t hdmaDest;
+			bool hdmaActive;
+		};
+		
 		GPU* gpu;
 		Joypad* joypad;
+		Serial* serial;
+		APU* apu;
 	
 		// Cart
 		Cart* cart;
 
 		// RAM
-		uint8_t* ram; // RAM
-		uint8_t* hram; // High RAM
+		uint8_t* ram; // RAM (8 banks of 4KB on CGB)
 		
-		// VRAM
+		// VRAM (2 banks of 8KB on CGB)
 		uint8_t* vram;
 		uint8_t* oam;
 		
-		// IO
+		// IO (FF00-FF7F), HRAM (FF80-FFFE) and IE (FFFF)
 		uint8_t* io;
 		
+		// CPU cycles the CPU is paused for by HDMA/GDMA
+		int dmaCycles;
+		
 		Memory(Cart* cart);
+		~Memory();
 		// RESET
 		void Reset();
+		// SAVESTATES
+		void SaveState(State* state);
+		void LoadState(const State* state);
 		// READ
 		uint8_t ReadByte(uint16_t address);
 		uint16_t ReadShort(uint16_t address);
@@ -40,14 +63,32 @@ class Memory
 		uint8_t* GetBytePointer(uint16_t address);
 		// INTERRUPTS
 		void RequestInterrupt(uint8_t flag);
+		// HBLANK (runs HDMA)
+		void OnHBlank();
 		
 	private:
-	
+		// Is in color mode
+		bool isCGB;
+		// Offsets of the switchable banks (VBK, SVBK)
+		int vramBank;
+		int ramBank;
+		// HDMA state (FF51-FF55)
+		bool hdmaActive;
+		uint16_t hdmaSource;
+		uint16_t hdmaDest;
 	
 		// Loads a ROM
 		void LoadRom(const char* filename);
 		// Copies to OAM (FF46)
 		void CopyToOAM(uint16_t address);
+		// Writes to OAM (tells the GPU about changes)
+		void WriteOAM(uint8_t index, uint8_t data);
+		// CGB bank switching (FF4F, FF70)
+		void OnVBK(uint8_t data);
+		void OnSVBK(uint8_t data);
+		// CGB VRAM DMA (FF55)
+		void OnHDMA5(uint8_t data);
+		void CopyHDMABlock();
 };
 
 #endif
\ No newline at end of file
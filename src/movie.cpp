@@ -0,0 +1,138 @@
+#include "movie.h"
+#include <stdio.h>
+#include <string.h>
+
+Movie::Movie()
+{
+	romHash = 0;
+}
+
+bool Movie::Record(GameBoy* gameboy, bool fromReset)
+{
+	romHash = gameboy->GetROMHash();
+	inputs.clear();
+	state.clear();
+	cartRAM.clear();
+	
+	// What's in the cart RAM is part of where it starts
+	if (fromReset)
+	{
+		gameboy->Reset();
+		cartRAM.assign(gameboy->GetCartRAM(), gameboy->GetCartRAM() + gameboy->GetCartRAMSize());
+		return true;
+	}
+	
+	// An empty state would make it a movie from a reset
+	state.resize(gameboy->GetStateSize());
+	state.resize((state.empty())? 0 : gameboy->SaveState(&state[0], state.size()));
+	
+	return !state.empty();
+}
+
+void Movie::AddFrame(uint8_t mask)
+{
+	inputs.push_back(mask);
+}
+
+bool Movie::Play(GameBoy* gameboy)
+{
+	if (!gameboy->IsLoaded() || gameboy->GetROMHash() != romHash)
+		return false;
+	
+	if (state.empty())
+	{
+		if (cartRAM.size() != gameboy->GetCartRAMSize())
+			return false;
+		
+		gameboy->Reset();
+		
+		if (!cartRAM.empty())
+			memcpy(gameboy->GetCartRAM(), &cartRAM[0], cartRAM.size());
+		
+		return true;
+	}
+	
+	return gameboy->LoadState(&state[0], state.size());
+}
+
+uint8_t Movie::GetInput(int frame)
+{
+	if (frame < 0 || frame >= (int)inputs.size())
+		return 0;
+	
+	return inputs[frame];
+}
+
+int Movie::GetFrameCount()
+{
+	return inputs.size();
+}
+
+bool Movie::Load(const char* filename)
+{
+	FILE* file = fopen(filename, "rb");
+	
+	if (!file)
+		return false;
+	
+	MovieHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+		header.magic == MOVIE_MAGIC && header.version == MOVIE_VERSION;
+	
+	// A damaged header can't ask for more than the file has
+	if (ok)
+	{
+		long start = ftell(file);
+		ok = start >= 0 && fseek(file, 0, SEEK_END) == 0;
+		long end = (ok)? ftell(file) : -1;
+		ok = end >= start && fseek(file, start, SEEK_SET) == 0 &&
+			(uint64_t)header.stateSize + header.cartRAMSize + header.frames <= (uint64_t)(end - start);
+	}
+	
+	if (ok)
+	{
+		romHash = header.romHash;
+		state.resize(header.stateSize);
+		cartRAM.resize(header.cartRAMSize);
+		inputs.resize(header.frames);
+		
+		if (header.stateSize)
+			ok = fread(&state[0], header.stateSize, 1, file) == 1;
+		if (ok && header.cartRAMSize)
+			ok = fread(&cartRAM[0], header.cartRAMSize, 1, file) == 1;
+		if (ok && header.frames)
+			ok = fread(&inputs[0], header.frames, 1, file) == 1;
+	}
+	
+	fclose(file);
+	return ok;
+}
+
+bool Movie::Save(const char* filename)
+{
+	FILE* file = fopen(filename, "wb");
+	
+	if (!file)
+		return false;
+	
+	// Zeroed so the padding is the same in every file
+	MovieHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = MOVIE_MAGIC;
+	header.version = MOVIE_VERSION;
+	header.romHash = romHash;
+	header.frames = inputs.size();
+	header.stateSize = state.size();
+	header.cartRAMSize = cartRAM.size();
+	
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	
+	if (ok && !state.empty())
+		ok = fwrite(&state[0], state.size(), 1, file) == 1;
+	if (ok && !cartRAM.empty())
+		ok = fwrite(&cartRAM[0], cartRAM.size(), 1, file) == 1;
+	if (ok && !inputs.empty())
+		ok = fwrite(&inputs[0], inputs.size(), 1, file) == 1;
+	
+	return fclose(file) == 0 && ok;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef __MOVIE__
+#define __MOVIE__
+
+#include <stdint.h>
+#include <vector>
+#include "gameboy.h"
+
+/*
+ * Input movie.
+ * The buttons held for every frame (set right before it runs), the
+ * hash of the ROM it was made on, and where it starts: a reset (with
+ * the cart RAM it had, a reset keeps battery saves), or a savestate.
+ * Playing it back through the core API gives the same run bit for bit.
+ *
+ * File: MovieHeader, the savestate (stateSize bytes), the cart RAM
+ * (cartRAMSize bytes, from a reset only), one BUTTON_* mask per frame.
+ * Movies with a savestate only play on the build that made them (see
+ * savestate.h).
+ */
+const uint32_t MOVIE_MAGIC = 0x4D424742; // "BGBM"
+const uint32_t MOVIE_VERSION = 2;
+
+struct MovieHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t romHash;
+	uint32_t frames;
+	// 0 = starts from a reset
+	uint32_t stateSize;
+	uint32_t cartRAMSize;
+};
+
+class Movie
+{
+	public:
+		Movie();
+		
+		// Starts a new movie from a reset (resets the gameboy), or from
+		// the gameboy's current state
+		// Returns false if the state couldn't be saved
+		bool Record(GameBoy* gameboy, bool fromReset = true);
+		// Adds the buttons held for the next frame
+		void AddFrame(uint8_t mask);
+		
+		// Gets the gameboy to where the movie starts (a reset also gets
+		// the cart RAM back)
+		// Returns false if it was made on another ROM
+		bool Play(GameBoy* gameboy);
+		// Buttons held for a frame (none past the end)
+		uint8_t GetInput(int frame);
+		int GetFrameCount();
+		
+		bool Load(const char* filename);
+		bool Save(const char* filename);
+		
+	private:
+		uint64_t romHash;
+		std::vector<uint8_t> state;
+		std::vector<uint8_t> cartRAM;
+		std::vector<uint8_t> inputs;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "render_thread.h"
+#include <string.h>
+
+const int CMD_VRAM = 0;
+const int CMD_OAM = 1;
+const int CMD_BG_COLOR = 2;
+const int CMD_OBJ_COLOR = 3;
+const int CMD_LINE = 4;
+
+RenderThread::RenderThread(Screen* screen)
+	: renderer(vram, oam, screen)
+{
+	memset(vram, 0, sizeof(vram));
+	memset(oam, 0, sizeof(oam));
+	
+	running = true;
+	sleeping = false;
+	waiting = false;
+	thread = std::thread(&RenderThread::Run, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		running = false;
+		workReady.notify_one();
+	}
+	
+	thread.join();
+}
+
+void RenderThread::Load(const uint8_t* vram, const uint8_t* oam, const Renderer* state, bool isCGB)
+{
+	Wait();
+	
+	memcpy(this->vram, vram, sizeof(this->vram));
+	memcpy(this->oam, oam, sizeof(this->oam));
+	
+	renderer.Reset(isCGB);
+	memcpy(renderer.bgPalette, state->bgPalette, sizeof(renderer.bgPalette));
+	memcpy(renderer.objPalette, state->objPalette, sizeof(renderer.objPalette));
+}
+
+void RenderThread::WriteVRAM(uint16_t address, uint8_t data)
+{
+	Command command;
+	command.type = CMD_VRAM;
+	command.address = address;
+	command.data = data;
+	Push(command);
+}
+
+void RenderThread::WriteOAM(uint8_t index, uint8_t data)
+{
+	Command command;
+	command.type = CMD_OAM;
+	command.address = index;
+	command.data = data;
+	Push(command);
+}
+
+void RenderThread::SetColor(bool isObj, int palette, int color, uint32_t argb)
+{
+	Command command;
+	command.type = (isObj)? CMD_OBJ_COLOR : CMD_BG_COLOR;
+	command.index = palette;
+	command.address = color;
+	command.data = argb;
+	Push(command);
+}
+
+void RenderThread::DrawLine(int ly, const LineRegisters& regs)
+{
+	Command command;
+	command.type = CMD_LINE;
+	command.index = ly;
+	command.regs = regs;
+	Push(command);
+	
+	// Changes are only drawn with a line, so that's when it's woken
+	Wake();
+}
+
+void RenderThread::Wait()
+{
+	if (commands.IsEmpty())
+		return;
+	
+	std::unique_lock<std::mutex> lock(mutex);
+	waiting = true;
+	// Seen by the worker before it checks waiting (or it's still working)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	workReady.notify_one();
+	workDone.wait(lock, [this] { return commands.IsEmpty(); });
+	waiting = false;
+}
+
+void RenderThread::Push(const Command& command)
+{
+	// If the worker is behind, let it catch up
+	while (!commands.Push(command))
+		Wait();
+}
+
+void RenderThread::Wake()
+{
+	// The command is in the queue before sleeping is checked (pairs with Run)
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	
+	if (sleeping)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		workReady.notify_one();
+	}
+}
+
+void RenderThread::Run()
+{
+	while (true)
+	{
+		Command* command = commands.Front();
+		
+		if (!command)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			sleeping = true;
+			// Pairs with Wake, a command pushed now is either seen here or wakes it
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			workReady.wait(lock, [this] { return !commands.IsEmpty() || !running; });
+			sleeping = false;
+			
+			if (!running && commands.IsEmpty())
+				break;
+			
+			continue;
+		}
+		
+		switch (command->type)
+		{
+			case CMD_VRAM: vram[command->address] = command->data; break;
+			case CMD_OAM: oam[command->address] = command->data; break;
+			case CMD_BG_COLOR: renderer.bgPalette[command->index][command->address] = command->data; break;
+			case CMD_OBJ_COLOR: renderer.objPalette[command->index][command->address] = command->data; break;
+			case CMD_LINE: renderer.DrawLine(command->index, command->regs); break;
+		}
+		
+		// Only remove once done, so an empty queue means everything is drawn
+		commands.Pop();
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		
+		if (waiting && commands.IsEmpty())
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			workDone.notify_one();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef __RENDER_THREAD__
+#define __RENDER_THREAD__
+
+#include "renderer.h"
+#include "ring_buffer.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "aligned.h"
+
+/*
+ * Draws scanlines on a worker thread.
+ * The emulation thread only queues VRAM/OAM/palette changes and
+ * per line register snapshots, the worker applies them to its own
+ * copy of VRAM/OAM and draws the lines in order.
+ * It's one pipelined worker (lines are drawn in order, while the CPU
+ * runs the next ones), not lines split across several. When the queue
+ * is empty it sleeps until the next line is queued, and waiting for it
+ * to finish sleeps too, so no core spins between frames.
+ */
+class RenderThread : public CacheAligned
+{
+	// Queued work
+	struct Command
+	{
+		uint8_t type;
+		uint8_t index;
+		uint16_t address;
+		union
+		{
+			uint32_t data;
+			LineRegisters regs;
+		};
+	};
+	
+	public:
+		RenderThread(Screen* screen);
+		~RenderThread();
+		
+		// Copies the current VRAM/OAM/palettes (worker must be idle)
+		void Load(const uint8_t* vram, const uint8_t* oam, const Renderer* state, bool isCGB);
+		
+		// Changes
+		void WriteVRAM(uint16_t address, uint8_t data);
+		void WriteOAM(uint8_t index, uint8_t data);
+		void SetColor(bool isObj, int palette, int color, uint32_t argb);
+		
+		// Draw a line
+		void DrawLine(int ly, const LineRegisters& regs);
+		
+		// Waits until everything queued has been drawn
+		void Wait();
+		
+	private:
+		RingBuffer<Command, 16384> commands;
+		
+		// Worker's copies
+		uint8_t vram[0x4000];
+		uint8_t oam[0xA0];
+		Renderer renderer;
+		
+		std::thread thread;
+		std::atomic<bool> running;
+		
+		// The worker is asleep (queue empty), the emulation thread is in Wait
+		std::mutex mutex;
+		std::condition_variable workReady;
+		std::condition_variable workDone;
+		std::atomic<bool> sleeping;
+		std::atomic<bool> waiting;
+		
+		void Push(const Command& command);
+		// Wakes the worker if it's asleep (only locks if it is)
+		void Wake();
+		void Run();
+};
+
+#endif
\ No newline at end of file
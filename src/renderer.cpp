@@ -0,0 +1,265 @@
+#include "renderer.h"
+
+const int CGB_BG_PALETTE = 0x07;
+const int CGB_BG_BANK = 0x08;
+const int CGB_BG_XFLIP = 0x20;
+const int CGB_BG_YFLIP = 0x40;
+const int CGB_BG_PRIORITY = 0x80;
+
+const int VRAM_BANK_SIZE = 0x2000;
+
+Renderer::Renderer(uint8_t* vram, uint8_t* oam, Screen* screen)
+{
+	this->vram = vram;
+	this->oam = oam;
+	this->screen = screen;
+	
+	Reset(false);
+}
+
+void Renderer::Reset(bool isCGB)
+{
+	this->isCGB = isCGB;
+	
+	for (int i = 0; i < 8; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			bgPalette[i][j] = 0;
+			objPalette[i][j] = 0;
+		}
+	}
+}
+
+void Renderer::DrawLine(int ly, const LineRegisters& regs)
+{
+	// Draw backgrounds
+	DrawBackground(ly, regs);
+	
+	if (regs.lcdc & 0x20)
+		DrawWindow(ly, regs);
+	
+	// If sprites are enabled, draw sprites
+	if (regs.lcdc & 0x02)
+		DrawSprites(ly, regs);
+	
+	screen->MarkLineDirty(ly);
+}
+
+void Renderer::DrawBackground(int ly, const LineRegisters& regs)
+{
+	// If the background should be shown, or all white (CGB always shows it)
+	bool showBackground = (regs.lcdc & 0x01) || isCGB;
+	// Find which tile map to use (depending on LCDC)
+	int dataAddr = (regs.lcdc & 0x10)? 0x0000 : 0x1000;
+	int bgMapAddr = (regs.lcdc & 0x08)? 0x1C00: 0x1800;
+	
+	// Calculate Y (y + scrollY % 256)
+	int wrappedY = (ly + regs.scy) & 0xFF;
+	// Get Y on map
+	int mapY = wrappedY / 8;
+	// Get Y in tile (wrappedY % 8)
+	int tileY = wrappedY & 7;
+	
+	// If background is disabled, fill with white
+	if (!showBackground)
+	{
+		for (int x = 0; x < 160; x++)
+		{
+			screen->SetPixel(x, ly, 0xFFFFFFFF);
+			bg_mask[x][ly] = 0;
+		}
+		
+		return;
+	}
+	
+	// Otherwise, draw backgrounds
+	for (int x = 0; x < 160; x++)
+	{
+		// Calculate X (x + scrollX % 256)
+		uint32_t wrappedX = (x + regs.scx) & 0xFF;
+		// Get X on map
+		int mapX = wrappedX / 8;
+		// Get tile x (wrappedX % 8)
+		int tileX = wrappedX & 7;
+		
+		// Map Tile = Map Base Addr + (y * 32) + x
+		// 32 is map width
+		int mapAddr = bgMapAddr + (mapY << 5) + mapX;
+		int tileIndex = vram[mapAddr];
+		// If using the second Tile Data area, convert to signed char
+		if (dataAddr == 0x1000) tileIndex = (int8_t)tileIndex;
+		
+		// CGB attributes are in VRAM bank 1, at the same address
+		int attributes = (isCGB)? vram[VRAM_BANK_SIZE + mapAddr] : 0;
+		int line = (attributes & CGB_BG_YFLIP)? 7 - tileY : tileY;
+		int bit = (attributes & CGB_BG_XFLIP)? tileX : 7 - tileX;
+		int bank = (attributes & CGB_BG_BANK)? VRAM_BANK_SIZE : 0;
+		
+		// Line = 2 bytes @ DataBaseAddr + (tileIndex * tileSize) + (tileY * lineSize)
+		int lsb = vram[bank + dataAddr + tileIndex * 16 + line * 2];
+		int msb = vram[bank + dataAddr + tileIndex * 16 + line * 2 + 1];
+		
+		// Calculate color index
+		int color_index;
+		color_index =  (lsb & (0x01 << bit))? 0x1 : 0x0;
+		color_index += (msb & (0x01 << bit))? 0x2 : 0x0;
+		
+		// Draw pixel
+		screen->SetPixel(x, ly, bgPalette[attributes & CGB_BG_PALETTE][color_index]);
+		
+		// If color == 0, then is 'transparent'
+		bg_mask[x][ly] = (color_index? 1 : 0) | ((attributes & CGB_BG_PRIORITY)? 2 : 0);
+	}
+}
+
+void Renderer::DrawSprites(int ly, const LineRegisters& regs)
+{
+	// LCDC Attributes
+	bool is8x16 = regs.lcdc & 0x04;
+	// CGB: if LCDC bit 0 is off, sprites are always on top
+	bool bgPriority = !isCGB || (regs.lcdc & 0x01);
+	
+	// Calculate sprite height
+	int sprite_height = (is8x16)? 16 : 8;
+	
+	for (int sprite = 39; sprite >= 0; sprite--)
+	{
+		int sprite_index = sprite * 4;
+		
+		// Get Y
+		int sprite_y = oam[sprite_index] - 16;
+		
+		// If not on line, skip
+		if (sprite_y > ly || (sprite_y + sprite_height) <= ly)
+			continue;
+		
+		// Get X
+		int sprite_x = oam[sprite_index + 1] - 8;
+		
+		// If not on screen, skip
+		if (sprite_x == -8 || sprite_x >= 160)
+			continue;
+		
+		// Get tile index
+		int tile_index = oam[sprite_index + 2] & (is8x16 ? 0xFE : 0xFF);
+		// Get sprite attributes
+		int sprite_attributes = oam[sprite_index + 3];
+		
+		bool x_flip = sprite_attributes & 0x20;
+		bool y_flip = sprite_attributes & 0x40;
+		bool behind_bg = sprite_attributes & 0x80;
+		int palette, bank;
+		
+		if (isCGB)
+		{
+			palette = sprite_attributes & 0x07;
+			bank = (sprite_attributes & 0x08)? VRAM_BANK_SIZE : 0;
+		}
+		else
+		{
+			palette = (sprite_attributes & 0x10) >> 4;
+			bank = 0;
+		}
+		
+		int tile_y = ly - sprite_y;
+		
+		if (y_flip)
+		{
+			tile_y = ((is8x16)? 15 : 7) - tile_y;
+		}
+		
+		if (tile_y >= 8)
+		{
+			tile_index |= 1;
+			tile_y -= 8;
+		}
+
+		// Get the tile line
+		int lsb, msb;
+		lsb = vram[bank + tile_index * 16 + tile_y * 2];
+		msb = vram[bank + tile_index * 16 + tile_y * 2 + 1];
+		
+		// Calculate sprite X bounds
+		int start = (sprite_x < 0)? 0 - sprite_x : 0;
+		int end = (sprite_x + 7 >= 160)? 160 - sprite_x : 8;
+		
+		for (int tile_x = start; tile_x < end; tile_x++)
+		{
+			int color_index;
+			color_index =  (lsb & (0x01 << (x_flip? tile_x : (7 - tile_x))))? 0x1 : 0x0;
+			color_index += (msb & (0x01 << (x_flip? tile_x : (7 - tile_x))))? 0x2 : 0x0;
+			
+			int bg_mode = bg_mask[sprite_x + tile_x][ly];
+			
+			// BG wins over the sprite if it isn't color 0 and either has priority
+			bool hidden = bgPriority && (bg_mode & 1) && (behind_bg || (bg_mode & 2));
+			
+			// If not transparent, draw
+			if (color_index && !hidden)
+			{
+				screen->SetPixel(sprite_x + tile_x, ly, objPalette[palette][color_index]);
+			}
+		}
+	}
+}
+
+void Renderer::DrawWindow(int ly, const LineRegisters& regs)
+{	
+	if (regs.wx > 166 || regs.wy > 143 || regs.wy > ly)
+		return;
+	
+	//printf("X %d Y %d \n", regs.wx, regs.wy);
+	
+	// Find which tile map to use (depending on LCDC)
+	int dataAddr = (regs.lcdc & 0x10)? 0x0000 : 0x1000;
+	int bgMapAddr = (regs.lcdc & 0x40)? 0x1C00: 0x1800;
+	
+	//printf("%d\n", regs.wy);
+	
+	// Calculate Y (y + scrollY % 256)
+	int wrappedY = (ly - regs.wy);
+	// Get Y on map
+	int mapY = wrappedY / 8;
+	// Get Y in tile (wrappedY % 8)
+	int tileY = wrappedY & 7;
+	
+	// Window starts at WX - 7 (can be off the left edge)
+	int windowLeft = regs.wx - 7;
+	
+	// Otherwise, draw backgrounds
+	for (int x = (windowLeft < 0)? 0 : windowLeft; x < 160; x++)
+	{
+		// Get X on map (relative to the window)
+		int mapX = (x - windowLeft) / 8;
+		// Get tile x (windowX % 8)
+		int tileX = (x - windowLeft) & 7;
+		
+		// Map Tile = Map Base Addr + (y * 32) + x
+		// 32 is map width
+		int mapAddr = bgMapAddr + (mapY << 5) + mapX;
+		int tileIndex = vram[mapAddr];
+		// If using the second Tile Data area, convert to signed char
+		if (dataAddr == 0x1000) tileIndex = (int8_t)tileIndex;
+		
+		// CGB attributes are in VRAM bank 1, at the same address
+		int attributes = (isCGB)? vram[VRAM_BANK_SIZE + mapAddr] : 0;
+		int line = (attributes & CGB_BG_YFLIP)? 7 - tileY : tileY;
+		int bit = (attributes & CGB_BG_XFLIP)? tileX : 7 - tileX;
+		int bank = (attributes & CGB_BG_BANK)? VRAM_BANK_SIZE : 0;
+		
+		// Line = 2 bytes @ DataBaseAddr + (tileIndex * tileSize) + (tileY * lineSize)
+		int lsb = vram[bank + dataAddr + tileIndex * 16 + line * 2];
+		int msb = vram[bank + dataAddr + tileIndex * 16 + line * 2 + 1];
+		
+		// Calculate color index
+		int color_index;
+		color_index =  (lsb & (0x01 << bit))? 0x1 : 0x0;
+		color_index += (msb & (0x01 << bit))? 0x2 : 0x0;
+		
+		bg_mask[x][ly] = (color_index? 1 : 0) | ((attributes & CGB_BG_PRIORITY)? 2 : 0);
+		
+		// Draw pixel
+		screen->SetPixel(x, ly, bgPalette[attributes & CGB_BG_PALETTE][color_index]);
+	}
+}
\ No newline at end of file
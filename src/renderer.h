@@ -0,0 +1,48 @@
+#ifndef __RENDERER__
+#define __RENDERER__
+
+#include <stdint.h>
+#include "screen.h"
+#include "aligned.h"
+
+// Registers a line depends on
+struct LineRegisters
+{
+	uint8_t lcdc, scy, scx, wy, wx;
+	uint8_t bgp, obp0, obp1;
+};
+
+/*
+ * Draws scanlines from VRAM, OAM and the palettes.
+ * Never touches Memory or IO, so it can draw from copies
+ * of them on another thread.
+ */
+class Renderer : public CacheAligned
+{
+	public:
+		// Palettes (ARGB, ready to draw)
+		uint32_t objPalette[8][4];
+		uint32_t bgPalette[8][4];
+		
+		Renderer(uint8_t* vram, uint8_t* oam, Screen* screen);
+		
+		void Reset(bool isCGB);
+		void DrawLine(int ly, const LineRegisters& regs);
+		
+	private:
+		uint8_t* vram;
+		uint8_t* oam;
+		Screen* screen;
+		
+		// Is in color mode
+		bool isCGB;
+		
+		// Bit 0: color index != 0, Bit 1: CGB BG priority
+		int bg_mask[160][144];
+		
+		void DrawBackground(int ly, const LineRegisters& regs);
+		void DrawSprites(int ly, const LineRegisters& regs);
+		void DrawWindow(int ly, const LineRegisters& regs);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "rewind.h"
+#include "delta.h"
+#include <string.h>
+
+#ifdef BETTERGB_LZ4
+#include <lz4.h>
+#endif
+
+Rewind::Rewind(GameBoy* gameboy, int interval, size_t capacity)
+{
+	this->gameboy = gameboy;
+	this->interval = (interval < 1)? 1 : interval;
+	this->capacity = capacity;
+	
+	current = NULL;
+	next = NULL;
+	delta = NULL;
+	packed = NULL;
+	bufferSize = 0;
+	
+	ring = new uint8_t[capacity];
+	
+	Clear();
+}
+
+Rewind::~Rewind()
+{
+	delete[] current;
+	delete[] next;
+	delete[] delta;
+	delete[] packed;
+	delete[] ring;
+}
+
+void Rewind::Clear()
+{
+	frameCounter = 0;
+	stateSize = 0;
+	behind = 0;
+	head = 0;
+	entries.clear();
+	entryBytes = 0;
+}
+
+void Rewind::Allocate(size_t size)
+{
+	if (size <= bufferSize)
+		return;
+	
+	delete[] current;
+	delete[] next;
+	delete[] delta;
+	delete[] packed;
+	
+	current = new uint8_t[size];
+	next = new uint8_t[size];
+	delta = new uint8_t[GetDeltaBound(size)];
+	
+#ifdef BETTERGB_LZ4
+	packed = new uint8_t[LZ4_compressBound(GetDeltaBound(size))];
+#else
+	packed = NULL;
+#endif
+
+	bufferSize = size;
+}
+
+void Rewind::OnFrame()
+{
+	frameCounter++;
+	behind++;
+	
+	if (frameCounter >= interval)
+	{
+		frameCounter = 0;
+		Push();
+	}
+}
+
+void Rewind::Push()
+{
+	Allocate(gameboy->GetStateSize());
+	
+	size_t size = gameboy->SaveState(next, bufferSize);
+	
+	if (!size)
+		return;
+	
+	// Another ROM was loaded, the old history is useless
+	if (stateSize && size != stateSize)
+		Clear();
+	
+	// Keep how to get from the new state back to the current one
+	if (stateSize)
+	{
+		size_t deltaSize = EncodeDelta(current, next, size, delta);
+		
+#ifdef BETTERGB_LZ4
+		// Unchanged runs are already gone, LZ4 gets the literals' repeats
+		int packedSize = LZ4_compress_default((const char*)delta, (char*)packed, (int)deltaSize, LZ4_compressBound(GetDeltaBound(size)));
+		
+		if (packedSize > 0 && (size_t)packedSize < deltaSize)
+			Store(packed, packedSize, true);
+		else
+			Store(delta, deltaSize, false);
+#else
+		Store(delta, deltaSize, false);
+#endif
+	}
+	
+	uint8_t* swap = current;
+	current = next;
+	next = swap;
+	stateSize = size;
+	behind = 0;
+}
+
+void Rewind::Store(const uint8_t* data, size_t size, bool compressed)
+{
+	// Doesn't fit at all, nothing before it can be stepped back to
+	if (size > capacity)
+	{
+		entries.clear();
+		entryBytes = 0;
+		head = 0;
+		return;
+	}
+	
+	// Deltas are never split, wrap to the start (the oldest deltas
+	// are the ones after head, they go first)
+	if (head + size > capacity)
+	{
+		while (!entries.empty() && entries.front().offset >= head)
+		{
+			entryBytes -= entries.front().size;
+			entries.pop_front();
+		}
+		
+		head = 0;
+	}
+	
+	// Drop the oldest deltas in the way
+	while (!entries.empty())
+	{
+		const Entry& oldest = entries.front();
+		
+		if (oldest.offset >= head + size || oldest.offset + oldest.size <= head)
+			break;
+		
+		entryBytes -= oldest.size;
+		entries.pop_front();
+	}
+	
+	memcpy(ring + head, data, size);
+	
+	Entry entry;
+	entry.offset = head;
+	entry.size = size;
+	entry.packed = compressed;
+	entries.push_back(entry);
+	
+	entryBytes += size;
+	head += size;
+}
+
+bool Rewind::StepBack()
+{
+	// The frame after a state 0 or 1 frames back isn't an earlier one,
+	// loading it would waste a step
+	while (stateSize && behind < 2)
+	{
+		Pop();
+		behind += interval;
+	}
+	
+	if (!stateSize)
+		return false;
+	
+	if (!gameboy->LoadState(current, stateSize))
+	{
+		Clear();
+		return false;
+	}
+	
+	Pop();
+	frameCounter = 0;
+	// The one before it is next, and a frame is run from the loaded one
+	behind = interval + 1;
+	return true;
+}
+
+void Rewind::Pop()
+{
+	if (entries.empty())
+	{
+		stateSize = 0;
+		return;
+	}
+	
+	const Entry& newest = entries.back();
+	const uint8_t* data = ring + newest.offset;
+	size_t size = newest.size;
+	bool decoded = true;
+	
+#ifdef BETTERGB_LZ4
+	if (newest.packed)
+	{
+		int deltaSize = LZ4_decompress_safe((const char*)data, (char*)delta, (int)size, (int)GetDeltaBound(stateSize));
+		decoded = deltaSize >= 0;
+		data = delta;
+		size = (decoded)? deltaSize : 0;
+	}
+#endif
+	
+	// A delta that doesn't decode leaves nothing to step back to
+	if (!decoded || !ApplyDelta(data, size, current, stateSize))
+	{
+		Clear();
+		return;
+	}
+	
+	entryBytes -= newest.size;
+	head = newest.offset;
+	entries.pop_back();
+}
+
+int Rewind::GetCount()
+{
+	if (!stateSize)
+		return 0;
+	
+	// Not the newest if it's too close to show an earlier frame
+	return entries.size() + ((behind < 2)? 0 : 1);
+}
+
+size_t Rewind::GetMemoryUsed()
+{
+	return entryBytes + stateSize;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef __REWIND__
+#define __REWIND__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include "gameboy.h"
+
+/*
+ * Rewind history.
+ * Saves a state every N frames. Only the newest one is kept whole,
+ * older ones are XOR deltas (see delta.h) against the one after them,
+ * so stepping back is decoding one delta. Deltas live in a fixed size
+ * byte ring, the oldest are dropped when it's full.
+ * With LZ4 (BETTERGB_LZ4) deltas are also compressed when that makes
+ * them smaller (10-25% less, ~1us a frame). Without it a frame's delta
+ * is ~60-450 bytes, 16MB holds 10+ minutes at a state per frame.
+ */
+class Rewind
+{
+	public:
+		// interval: frames between states, capacity: bytes of deltas to keep
+		Rewind(GameBoy* gameboy, int interval = 1, size_t capacity = 16 << 20);
+		~Rewind();
+		
+		// Call after every emulated frame
+		void OnFrame();
+		// Loads the newest state the frame after which is earlier than the
+		// last one shown (a frame is run after it, without OnFrame) and
+		// drops it, false if there's no history
+		bool StepBack();
+		void Clear();
+		
+		// States that can be stepped back to
+		int GetCount();
+		// Bytes used by the history (deltas and the newest state)
+		size_t GetMemoryUsed();
+		
+	private:
+		// Where a delta is in the ring
+		struct Entry
+		{
+			size_t offset;
+			size_t size;
+			bool packed; // LZ4 compressed
+		};
+		
+		GameBoy* gameboy;
+		int interval;
+		int frameCounter;
+		
+		// The newest state (whole), and the one being saved
+		uint8_t* current;
+		uint8_t* next;
+		size_t stateSize; // 0 = no newest state
+		size_t bufferSize;
+		// Frames the game is past the newest state
+		int behind;
+		
+		// Delta being encoded, and compressed
+		uint8_t* delta;
+		uint8_t* packed;
+		
+		uint8_t* ring;
+		size_t capacity;
+		size_t head; // Where the next delta goes
+		std::deque<Entry> entries; // Oldest first
+		size_t entryBytes;
+		
+		void Push();
+		void Store(const uint8_t* data, size_t size, bool compressed);
+		// The state before the newest becomes the newest
+		void Pop();
+		void Allocate(size_t size);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef __RING_BUFFER__
+#define __RING_BUFFER__
+
+#include <stddef.h>
+#include <atomic>
+
+/*
+ * Lock-free single producer, single consumer ring buffer.
+ * SIZE must be a power of 2.
+ */
+template <typename T, size_t SIZE>
+class RingBuffer
+{
+	static_assert((SIZE & (SIZE - 1)) == 0, "RingBuffer SIZE must be a power of 2");
+	
+	public:
+		RingBuffer() : head(0), tail(0) {}
+		
+		// PRODUCER
+		// Returns false if full
+		bool Push(const T& item)
+		{
+			size_t h = head.load(std::memory_order_relaxed);
+			
+			if (h - tail.load(std::memory_order_acquire) == SIZE)
+				return false;
+			
+			items[h & (SIZE - 1)] = item;
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+		
+		// Pushes up to count items, returns how many fit
+		size_t Push(const T* data, size_t count)
+		{
+			size_t h = head.load(std::memory_order_relaxed);
+			size_t space = SIZE - (h - tail.load(std::memory_order_acquire));
+			
+			if (count > space)
+				count = space;
+			
+			for (size_t i = 0; i < count; i++)
+				items[(h + i) & (SIZE - 1)] = data[i];
+			
+			head.store(h + count, std::memory_order_release);
+			return count;
+		}
+		
+		// CONSUMER
+		// Returns the oldest item without removing it (NULL if empty)
+		T* Front()
+		{
+			size_t t = tail.load(std::memory_order_relaxed);
+			
+			if (t == head.load(std::memory_order_acquire))
+				return NULL;
+			
+			return &items[t & (SIZE - 1)];
+		}
+		
+		// Removes the oldest item (after Front)
+		void Pop()
+		{
+			tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+		
+		// Returns false if empty
+		bool Pop(T& item)
+		{
+			T* front = Front();
+			
+			if (!front)
+				return false;
+			
+			item = *front;
+			Pop();
+			return true;
+		}
+		
+		// Pops up to count items, returns how many there were
+		size_t Pop(T* data, size_t count)
+		{
+			size_t t = tail.load(std::memory_order_relaxed);
+			size_t available = head.load(std::memory_order_acquire) - t;
+			
+			if (count > available)
+				count = available;
+			
+			for (size_t i = 0; i < count; i++)
+				data[i] = items[(t + i) & (SIZE - 1)];
+			
+			tail.store(t + count, std::memory_order_release);
+			return count;
+		}
+		
+		// EITHER
+		size_t Count() const
+		{
+			return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+		}
+		
+		bool IsEmpty() const
+		{
+			return Count() == 0;
+		}
+		
+	private:
+		T items[SIZE];
+		// Producer and consumer indices on separate cache lines
+		// (padding instead of alignas, new doesn't over-align in C++11)
+		char padding0[64];
+		std::atomic<size_t> head;
+		char padding1[64];
+		std::atomic<size_t> tail;
+		char padding2[64];
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "run_ahead.h"
+#include <chrono>
+
+RunAhead::RunAhead(GameBoy* gameboy, int frames)
+{
+	this->gameboy = gameboy;
+	
+	state = NULL;
+	bufferSize = 0;
+	stateMicros = 0;
+	
+	SetFrames(frames);
+}
+
+RunAhead::~RunAhead()
+{
+	delete[] state;
+}
+
+void RunAhead::SetFrames(int frames)
+{
+	this->frames = (frames < 0)? 0 : frames;
+}
+
+int RunAhead::GetFrames()
+{
+	return frames;
+}
+
+double RunAhead::GetStateMicros()
+{
+	return stateMicros;
+}
+
+void RunAhead::RunFrame()
+{
+	size_t size = (frames)? gameboy->GetStateSize() : 0;
+	
+	if (!size)
+	{
+		gameboy->RunFrame();
+		return;
+	}
+	
+	if (size > bufferSize)
+	{
+		delete[] state;
+		state = new uint8_t[size];
+		bufferSize = size;
+	}
+	
+	// Frame 0 is the real one. A request draws the frame after the one
+	// it's made before, so only the last ahead frame is drawn
+	for (int i = 0; i <= frames; i++)
+	{
+		if (i == frames - 1)
+			gameboy->RequestFrame();
+		
+		if (i == 1)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			size = gameboy->SaveState(state, bufferSize);
+			stateMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			
+			// No way back, don't leave the real timeline
+			if (!size)
+				return;
+			
+			gameboy->SetSpeculative(true);
+		}
+		
+		gameboy->RunFrame();
+	}
+	
+	// Back to the real timeline
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	gameboy->LoadState(state, size);
+	stateMicros += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	gameboy->SetSpeculative(false);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __RUN_AHEAD__
+#define __RUN_AHEAD__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gameboy.h"
+
+/*
+ * Run-ahead (hides the lag games have between reading a button and
+ * showing it).
+ * Every frame runs undrawn, then its state is saved, N more frames run
+ * with the same input (speculative: muted, only the last one drawn)
+ * and the state is loaded back. The screen always shows N frames
+ * ahead of the real timeline, which the ahead frames never touch.
+ * Frame skip is left on demand (0), only the last frame is requested.
+ */
+class RunAhead
+{
+	public:
+		RunAhead(GameBoy* gameboy, int frames = 1);
+		~RunAhead();
+		
+		// Frames to run ahead (0 = off, frames run as usual)
+		void SetFrames(int frames);
+		int GetFrames();
+		
+		// Runs a frame (input set beforehand), the screen is N frames ahead of it
+		void RunFrame();
+		
+		// Time the last frame's save + load took (microseconds)
+		double GetStateMicros();
+		
+	private:
+		GameBoy* gameboy;
+		int frames;
+		
+		uint8_t* state;
+		size_t bufferSize;
+		
+		double stateMicros;
+};
+
+#endif
\ No newline at end of file
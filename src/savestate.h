@@ -0,0 +1,38 @@
+#ifndef __SAVESTATE__
+#define __SAVESTATE__
+
+#include <stdint.h>
+
+/*
+ * Savestate layout.
+ * A header, then the plain data State blocks of every device
+ * (CPU, GPU, Memory, Joypad, Serial, APU, Cart) and the raw memory
+ * regions (WRAM, VRAM, OAM, IO with HRAM, cart RAM), so saving and
+ * loading is a handful of memcpys. DMG states only hold the DMG
+ * sized WRAM and VRAM.
+ *
+ * With SAVESTATE_LZ4 everything after the header is LZ4 compressed.
+ * States are only loaded by the same build on the same ROM, any
+ * change to the layout bumps SAVESTATE_VERSION.
+ */
+const uint32_t SAVESTATE_MAGIC = 0x53424742; // "BGBS"
+const uint32_t SAVESTATE_VERSION = 4;
+
+// Header flags
+const uint32_t SAVESTATE_CGB = 1 << 0;
+const uint32_t SAVESTATE_LZ4 = 1 << 1;
+
+struct SaveStateHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t flags;
+	// Header checksums (0x14D-0x14F) of the ROM it was saved on
+	uint32_t romCheck;
+	// Bytes after the header (uncompressed)
+	uint32_t size;
+	// Bytes stored after the header
+	uint32_t packedSize;
+};
+
+#endif
\ No newline at end of file
@@ -1,68 +1,46 @@
 #include "screen.h"
-
-const int DEFAULT_WIDTH = 320;
-const int DEFAULT_HEIGHT = 288;
-
-const int GB_WIDTH = 160;
-const int GB_HEIGHT = 144;
+#include <string.h>
 
 Screen::Screen()
 {
-	window = NULL;
-	
-	// Create window
-	window = SDL_CreateWindow( 
-		"SDL Tutorial", 
-		SDL_WINDOWPOS_UNDEFINED, 
-		SDL_WINDOWPOS_UNDEFINED, 
-		DEFAULT_WIDTH, 
-		DEFAULT_HEIGHT, 
-		SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE );
-	
-	// Get the window surface
-	CreateWindowSurface();
+	memset(pixels, 0, sizeof(pixels));
 	
-	// Create the game boy surface
-	CreateGameBoySurface();
+	MarkAllDirty();
 }
 
-void Screen::CreateWindowSurface()
+void Screen::SetPixel(int x, int y, uint32_t color)
 {
-	windowSurface = SDL_GetWindowSurface(window);
+	pixels[(y * WIDTH) + x] = color;
 }
 
-void Screen::CreateGameBoySurface()
+void Screen::MarkLineDirty(int y)
 {
-	gameboySurface = SDL_CreateRGBSurface(0, GB_WIDTH, GB_HEIGHT, 32, 0, 0, 0, 0);
+	dirtyLines[y] = true;
+	isDirty = true;
 }
 
-void Screen::OnEvent(SDL_Event* e)
+void Screen::MarkAllDirty()
 {
-	if (e->type == SDL_WINDOWEVENT)
-	{
-		switch (e->window.event)
-		{
-			// If screen is resized, get new window surface
-			case SDL_WINDOWEVENT_RESIZED:
-				CreateWindowSurface();
-				break;
-		}
-	}
+	for (int y = 0; y < HEIGHT; y++)
+		dirtyLines[y] = true;
+	
+	isDirty = true;
 }
 
-void Screen::Draw()
+bool Screen::IsDirty()
 {
-	SDL_BlitScaled(gameboySurface, NULL, windowSurface, NULL);
-	SDL_UpdateWindowSurface(window);
+	return isDirty;
 }
 
-void Screen::SetPixel(int x, int y, Uint32 color)
+bool Screen::IsLineDirty(int y)
 {
-	uint32_t * pixels = (uint32_t *) gameboySurface->pixels;
-	pixels[(y * gameboySurface->w) + x] = color;
+	return dirtyLines[y];
 }
 
-void Screen::OnDestroy()
+void Screen::ClearDirty()
 {
-	SDL_DestroyWindow( window );
-}
+	for (int y = 0; y < HEIGHT; y++)
+		dirtyLines[y] = false;
+	
+	isDirty = false;
+}
\ No newline at end of file
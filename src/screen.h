@@ -1,25 +1,36 @@
 #ifndef __SCREEN__
 #define __SCREEN__
 
-#include <SDL.h>
+#include <stdint.h>
 #include <stdio.h>
+#include "aligned.h"
 
-class Screen
+/*
+ * The Gameboy's LCD.
+ * 160x144 pixels, 0xAARRGGBB (XRGB8888), plus which lines
+ * changed since the frontend last presented it.
+ */
+class Screen : public CacheAligned
 {
 	public:
-		SDL_Surface* gameboySurface;
+		static const int WIDTH = 160;
+		static const int HEIGHT = 144;
+		
+		uint32_t pixels[WIDTH * HEIGHT];
 	
 		Screen();
-		void OnEvent(SDL_Event* e);
-		void Draw();
 		void SetPixel(int x, int y, uint32_t color);
-		void OnDestroy();
+		
+		// Dirty lines
+		void MarkLineDirty(int y);
+		void MarkAllDirty();
+		bool IsDirty();
+		bool IsLineDirty(int y);
+		void ClearDirty();
 	private:
-		SDL_Window* window;
-		SDL_Surface* windowSurface;	
-			
-		void CreateWindowSurface();
-		void CreateGameBoySurface();
+		// Lines changed since the last draw
+		bool dirtyLines[HEIGHT];
+		bool isDirty;
 };
 
 #endif
\ No newline at end of file
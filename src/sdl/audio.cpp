@@ -0,0 +1,113 @@
+#include "audio.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+// Samples per callback (~10ms at 48 kHz)
+const int CALLBACK_SAMPLES = 512;
+// Samples (per channel) kept in the ring (~43ms at 48 kHz)
+const int TARGET_FILL = 2048;
+// Most the sample rate is bent by (pitch changes below ~0.5% go unnoticed)
+const double MAX_RATE_DELTA = 0.005;
+
+Audio::Audio(int sampleRate)
+{
+	last[0] = 0;
+	last[1] = 0;
+	playing = false;
+	
+	SDL_AudioSpec want, have;
+	memset(&want, 0, sizeof(want));
+	want.freq = sampleRate;
+	want.format = AUDIO_S16SYS;
+	want.channels = 2;
+	want.samples = CALLBACK_SAMPLES;
+	want.callback = Callback;
+	want.userdata = this;
+	
+	device = SDL_OpenAudioDevice(NULL, 0, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+	this->sampleRate = (device)? have.freq : sampleRate;
+	
+	if (device)
+		SDL_PauseAudioDevice(device, 0);
+	else
+		printf("No audio: %s\n", SDL_GetError());
+}
+
+Audio::~Audio()
+{
+	if (device)
+		SDL_CloseAudioDevice(device);
+}
+
+bool Audio::IsOpen()
+{
+	return device != 0;
+}
+
+int Audio::GetSampleRate()
+{
+	return sampleRate;
+}
+
+int Audio::GetFill()
+{
+	return (int)ring.Count() / 2;
+}
+
+double Audio::GetControlledRate()
+{
+	// Too little in the ring: make a bit more per frame, too much: a bit less
+	double error = (double)(TARGET_FILL - GetFill()) / TARGET_FILL;
+	
+	if (error > 1)
+		error = 1;
+	else if (error < -1)
+		error = -1;
+	
+	return sampleRate * (1 + MAX_RATE_DELTA * error);
+}
+
+void Audio::Wait()
+{
+	// Only sleeps once, a stalled device doesn't stall the emulation
+	int excess = GetFill() - TARGET_FILL;
+	
+	if (device && excess > 0)
+		std::this_thread::sleep_for(std::chrono::microseconds((int64_t)excess * 1000000 / sampleRate));
+}
+
+void Audio::OnSamples(const int16_t* samples, int count)
+{
+	// Whatever doesn't fit is dropped (running faster than real time)
+	ring.Push(samples, count * 2);
+}
+
+void Audio::Callback(void* userdata, Uint8* stream, int length)
+{
+	Audio* audio = (Audio*)userdata;
+	int16_t* out = (int16_t*)stream;
+	int count = length / sizeof(int16_t);
+	
+	// Start (again) once there's some room for jitter
+	if (!audio->playing && audio->GetFill() >= TARGET_FILL)
+		audio->playing = true;
+	
+	int read = (audio->playing)? (int)audio->ring.Pop(out, count) : 0;
+	
+	if (read < count)
+		audio->playing = false;
+	
+	if (read >= 2)
+	{
+		audio->last[0] = out[read - 2];
+		audio->last[1] = out[read - 1];
+	}
+	
+	for (int i = read; i < count; i += 2)
+	{
+		out[i] = audio->last[0];
+		out[i + 1] = audio->last[1];
+	}
+}
\ No newline at end of file
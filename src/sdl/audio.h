@@ -0,0 +1,51 @@
+#ifndef __AUDIO__
+#define __AUDIO__
+
+#include <SDL.h>
+#include "../apu.h"
+#include "../ring_buffer.h"
+
+/*
+ * Plays the Gameboy's sound through SDL.
+ * The emulation thread pushes every frame's samples into a lock-free
+ * ring, SDL's audio callback pulls them out on its own thread.
+ * The ring is kept around TARGET_FILL: GetControlledRate says how fast
+ * to make samples so it drifts back there (never more than 0.5% off,
+ * which can't be heard), and Wait lets the ring's fill pace the
+ * emulation instead of a clock (audio sync).
+ */
+class Audio : public AudioSink
+{
+	public:
+		Audio(int sampleRate = 48000);
+		~Audio();
+		// False if there's no audio device
+		bool IsOpen();
+		// What the device actually plays at
+		int GetSampleRate();
+		
+		// Sample rate to generate at to stay near TARGET_FILL
+		double GetControlledRate();
+		// Sleeps until the ring is back down to TARGET_FILL
+		void Wait();
+		
+		void OnSamples(const int16_t* samples, int count);
+	private:
+		SDL_AudioDeviceID device;
+		int sampleRate;
+		
+		// Interleaved stereo (~170ms at 48 kHz)
+		RingBuffer<int16_t, 16384> ring;
+		
+		// Last sample played, held when the ring runs dry (no clicks)
+		int16_t last[2];
+		// Playback waits for TARGET_FILL after running dry (callback only)
+		bool playing;
+		
+		// Samples (per channel) in the ring
+		int GetFill();
+		
+		static void Callback(void* userdata, Uint8* stream, int length);
+};
+
+#endif
\ No newline at end of file
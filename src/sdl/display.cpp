@@ -0,0 +1,125 @@
+#include "display.h"
+#include <string.h>
+
+const int DEFAULT_WIDTH = 320;
+const int DEFAULT_HEIGHT = 288;
+
+const int GB_WIDTH = Screen::WIDTH;
+const int GB_HEIGHT = Screen::HEIGHT;
+
+Display::Display(bool vsync)
+{
+	// Create window
+	window = SDL_CreateWindow( 
+		"BetterGB", 
+		SDL_WINDOWPOS_UNDEFINED, 
+		SDL_WINDOWPOS_UNDEFINED, 
+		DEFAULT_WIDTH, 
+		DEFAULT_HEIGHT, 
+		SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE );
+	
+	// Hardware renderer if there is one, software otherwise
+	Uint32 flags = (vsync)? SDL_RENDERER_PRESENTVSYNC : 0;
+	
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | flags);
+	
+	if (!renderer)
+		renderer = SDL_CreateRenderer(window, -1, flags);
+	
+	// Sharp pixels, the screen keeps its aspect ratio
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+	SDL_RenderSetLogicalSize(renderer, GB_WIDTH, GB_HEIGHT);
+	
+	texture = CreateTexture();
+	
+	// Assume 60Hz if the display doesn't say
+	SDL_DisplayMode mode;
+	this->vsync = vsync;
+	refreshRate = 60;
+	
+	if (SDL_GetDesktopDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0)
+		refreshRate = mode.refresh_rate;
+	
+	memset(textureVersion, 0, sizeof(textureVersion));
+	redrawAll = true;
+}
+
+Display::~Display()
+{
+	SDL_DestroyTexture(texture);
+	SDL_DestroyRenderer(renderer);
+	SDL_DestroyWindow(window);
+}
+
+bool Display::IsVsync()
+{
+	return vsync;
+}
+
+int Display::GetRefreshRate()
+{
+	return refreshRate;
+}
+
+void Display::OnEvent(SDL_Event* e)
+{
+	// The renderer lost its textures (a D3D device reset), resizing
+	// the window doesn't touch them
+	if (e->type == SDL_RENDER_TARGETS_RESET || e->type == SDL_RENDER_DEVICE_RESET)
+	{
+		SDL_DestroyTexture(texture);
+		texture = CreateTexture();
+		redrawAll = true;
+	}
+}
+
+SDL_Texture* Display::CreateTexture()
+{
+	// Same layout as Screen::pixels (0xAARRGGBB)
+	return SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, GB_WIDTH, GB_HEIGHT);
+}
+
+void Display::Draw(const TripleBuffer::Frame* frame)
+{
+	// Lines that changed since they were last uploaded
+	int first = GB_HEIGHT;
+	int last = -1;
+	
+	for (int line = 0; line < GB_HEIGHT; line++)
+	{
+		if (redrawAll || frame->lineVersion[line] != textureVersion[line])
+		{
+			if (first == GB_HEIGHT)
+				first = line;
+			last = line;
+		}
+	}
+	
+	redrawAll = false;
+	
+	// Upload them (locked pixels are write only, so every line
+	// from the first to the last changed one is written)
+	if (last >= first)
+	{
+		SDL_Rect rect = { 0, first, GB_WIDTH, last - first + 1 };
+		void* pixels;
+		int pitch;
+		
+		if (SDL_LockTexture(texture, &rect, &pixels, &pitch) == 0)
+		{
+			for (int line = first; line <= last; line++)
+			{
+				memcpy((uint8_t*)pixels + (line - first) * pitch,
+					&frame->pixels[line * GB_WIDTH], GB_WIDTH * sizeof(uint32_t));
+				textureVersion[line] = frame->lineVersion[line];
+			}
+			
+			SDL_UnlockTexture(texture);
+		}
+	}
+	
+	// The renderer scales it to the window
+	SDL_RenderClear(renderer);
+	SDL_RenderCopy(renderer, texture, NULL, NULL);
+	SDL_RenderPresent(renderer);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef __DISPLAY__
+#define __DISPLAY__
+
+#include <SDL.h>
+#include "../triple_buffer.h"
+
+/*
+ * SDL window showing the Gameboy's screen.
+ * Changed lines are written straight into a streaming texture,
+ * the renderer (GPU) scales it to the window.
+ */
+class Display
+{
+	public:
+		// vsync: presenting waits for the display's refresh
+		Display(bool vsync = false);
+		~Display();
+		void OnEvent(SDL_Event* e);
+		// Uploads the lines of the frame that changed and presents
+		void Draw(const TripleBuffer::Frame* frame);
+		
+		// If presenting waits for the display's refresh
+		bool IsVsync();
+		// The display's refresh rate (Hz)
+		int GetRefreshRate();
+	private:
+		SDL_Window* window;
+		SDL_Renderer* renderer;
+		SDL_Texture* texture;
+		
+		bool vsync;
+		int refreshRate;
+		
+		// Line versions in the texture
+		uint32_t textureVersion[Screen::HEIGHT];
+		
+		// Texture contents were lost, upload everything
+		bool redrawAll;
+		
+		SDL_Texture* CreateTexture();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "frame_pacer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <chrono>
+#else
+#include <time.h>
+#include <errno.h>
+#endif
+
+// A frame is 70224 cycles at 4194304 Hz (59.7275 Hz)
+const uint64_t CLOCK_HZ = 4194304;
+const uint64_t FRAME_CYCLES = 70224;
+const uint64_t NS_PER_SEC = 1000000000;
+
+// Woken this long before a deadline, then spins (covers the scheduler's slack)
+#ifdef _WIN32
+const int64_t SPIN_NS = 2000000; // Sleep only has 1ms resolution (timeBeginPeriod(1))
+#else
+const int64_t SPIN_NS = 200000;
+#endif
+
+// Further behind than this (breakpoint, window drag, slow host),
+// start again from now instead of rushing frames to catch up
+const int64_t MAX_LATE_NS = 100000000;
+
+FramePacer::FramePacer()
+{
+	speed = 1;
+	turbo = false;
+	wasThrottled = false;
+	lateness = 0;
+	
+	Reset();
+}
+
+void FramePacer::SetSpeed(int speed)
+{
+	this->speed = (speed < 0)? UNTHROTTLED : speed;
+	
+	// The remainder is in units of the old speed
+	Reset();
+}
+
+int FramePacer::GetSpeed()
+{
+	return speed;
+}
+
+void FramePacer::SetTurbo(bool turbo)
+{
+	this->turbo = turbo;
+}
+
+bool FramePacer::IsThrottled()
+{
+	return !turbo && speed != UNTHROTTLED;
+}
+
+void FramePacer::Reset()
+{
+	deadline = Now();
+	remainder = 0;
+}
+
+int64_t FramePacer::GetLateness()
+{
+	return lateness;
+}
+
+void FramePacer::Wait()
+{
+	if (!IsThrottled())
+	{
+		wasThrottled = false;
+		lateness = 0;
+		return;
+	}
+	
+	// Coming out of turbo, the old deadline is long gone
+	if (!wasThrottled)
+	{
+		wasThrottled = true;
+		Reset();
+	}
+	
+	// Next deadline, exactly FRAME_CYCLES / (CLOCK_HZ * speed) seconds later
+	uint64_t scale = CLOCK_HZ * speed;
+	remainder += FRAME_CYCLES * NS_PER_SEC;
+	deadline += remainder / scale;
+	remainder %= scale;
+	
+	int64_t now = Now();
+	
+	if (now - deadline > MAX_LATE_NS)
+	{
+		lateness = now - deadline;
+		Reset();
+		return;
+	}
+	
+	if (deadline - now > SPIN_NS)
+		SleepUntil(deadline - SPIN_NS);
+	
+	while ((now = Now()) < deadline)
+		;
+	
+	lateness = now - deadline;
+}
+
+#ifdef _WIN32
+int64_t FramePacer::Now()
+{
+	using namespace std::chrono;
+	return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::SleepUntil(int64_t time)
+{
+	int64_t ms = (time - Now()) / 1000000;
+	
+	if (ms > 0)
+		Sleep((DWORD)ms);
+}
+#else
+int64_t FramePacer::Now()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+void FramePacer::SleepUntil(int64_t time)
+{
+	timespec ts;
+	ts.tv_sec = time / NS_PER_SEC;
+	ts.tv_nsec = time % NS_PER_SEC;
+	
+	// Absolute, so after a signal it just sleeps again for what's left
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef __FRAME_PACER__
+#define __FRAME_PACER__
+
+#include <stdint.h>
+
+/*
+ * Paces the emulation thread to the Gameboy's 59.7275 Hz (times a
+ * speed multiplier), or not at all.
+ * Deadlines are absolute and kept in integer nanoseconds (plus the
+ * exact remainder), so they never drift. Sleeps until just before
+ * a deadline, then spins for the rest.
+ */
+class FramePacer
+{
+	public:
+		// Speed for running as fast as possible
+		static const int UNTHROTTLED = 0;
+		
+		FramePacer();
+		
+		// 1, 2, 4, 8... times normal speed (or UNTHROTTLED)
+		void SetSpeed(int speed);
+		int GetSpeed();
+		// Unthrottled while set, back to the speed after
+		void SetTurbo(bool turbo);
+		bool IsThrottled();
+		
+		// Waits until the next frame is due
+		void Wait();
+		// Paces from now on (after a pause, turbo or a speed change)
+		void Reset();
+		
+		// How late the last Wait returned (ns)
+		int64_t GetLateness();
+	private:
+		int speed;
+		bool turbo;
+		bool wasThrottled;
+		
+		// Next frame's deadline, plus the fraction of a ns (in 1/(CLOCK_HZ * speed))
+		int64_t deadline;
+		uint64_t remainder;
+		
+		int64_t lateness;
+		
+		static int64_t Now();
+		static void SleepUntil(int64_t time);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,461 @@
+#include "frontend.h"
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Longest poll delay (leaves the rest of the frame to run it)
+const int MAX_POLL_DELAY = 12;
+
+// How far a stick has to be pushed to press the d-pad (of 32767)
+const int STICK_THRESHOLD = 16384;
+
+Frontend::Frontend(GameBoy* gameboy, int rewindInterval, bool vsync, bool sound)
+{
+	this->gameboy = gameboy;
+	
+	display = new Display(vsync);
+	audio = (sound)? new Audio() : NULL;
+	
+	// No device, no sound
+	if (audio && !audio->IsOpen())
+	{
+		delete audio;
+		audio = NULL;
+	}
+	
+	frames = new TripleBuffer();
+	rewind = (rewindInterval > 0)? new Rewind(gameboy, rewindInterval) : NULL;
+	runAhead = NULL;
+	
+	movie = NULL;
+	recording = false;
+	movieFrame = 0;
+	capture = NULL;
+	pollDelay = std::chrono::microseconds(0);
+	
+	quit = false;
+	input = 0;
+	keyButtons = 0;
+	padButtons = 0;
+	stickButtons = 0;
+	rewinding = false;
+	turbo = false;
+	frameWanted = true;
+	turboFrameSkip = true;
+	decimating = false;
+	audioSync = false;
+	playing = false;
+	opcodeDebug = false;
+	frameLimiterDebug = false;
+	
+	#ifdef _WIN32
+	timeBeginPeriod(1);
+	#endif
+}
+
+Frontend::~Frontend()
+{
+	#ifdef _WIN32
+	timeEndPeriod(1);
+	#endif
+	
+	gameboy->SetAudioSink(NULL);
+	gameboy->SetInputQueue(NULL);
+	
+	if (capture)
+	{
+		if (!capture->Close())
+			printf("Could not write the capture\n");
+		else if (capture->GetDroppedFrames())
+			printf("Capture dropped %d frames\n", capture->GetDroppedFrames());
+	}
+	
+	for (size_t i = 0; i < controllers.size(); i++)
+		SDL_GameControllerClose(controllers[i]);
+	
+	delete capture;
+	delete runAhead;
+	delete rewind;
+	delete frames;
+	delete audio;
+	delete display;
+}
+
+void Frontend::SetMovie(Movie* movie, bool recording)
+{
+	this->movie = movie;
+	this->recording = recording;
+	movieFrame = 0;
+}
+
+void Frontend::SetSpeed(int speed)
+{
+	pacer.SetSpeed(speed);
+}
+
+void Frontend::SetTurboFrameSkip(bool enabled)
+{
+	turboFrameSkip = enabled;
+}
+
+void Frontend::SetAudioSync(bool enabled)
+{
+	audioSync = enabled;
+}
+
+bool Frontend::StartCapture(const char* filename)
+{
+	if (!capture)
+		capture = new Capture();
+	
+	// At the rate the device plays (the sound is passed on to it)
+	int sampleRate = (audio)? audio->GetSampleRate() : 48000;
+	
+	if (!capture->Open(filename, gameboy->GetROMHash(), sampleRate))
+		return false;
+	
+	// Every frame is drawn (Run ignores the frame skip while capturing,
+	// unthrottled only presenting is decimated)
+	turboFrameSkip = false;
+	capture->SetNextSink((playing)? audio : NULL);
+	gameboy->SetAudioSink(capture, sampleRate);
+	return true;
+}
+
+void Frontend::SetPollDelay(int ms)
+{
+	if (ms < 0)
+		ms = 0;
+	else if (ms > MAX_POLL_DELAY)
+		ms = MAX_POLL_DELAY;
+	
+	pollDelay = std::chrono::milliseconds(ms);
+}
+
+void Frontend::SetRunAhead(int frames)
+{
+	delete runAhead;
+	runAhead = (frames > 0)? new RunAhead(gameboy, frames) : NULL;
+}
+
+bool Frontend::LoadInputMap(const char* filename)
+{
+	return inputMap.Load(filename);
+}
+
+void Frontend::Loop()
+{
+	// SDL stays on this thread (events and rendering must be on the window's thread)
+	quit = false;
+	thread = std::thread(&Frontend::Run, this);
+	
+	std::chrono::steady_clock::duration refreshTime = std::chrono::microseconds(1000000 / display->GetRefreshRate());
+	presentTime = std::chrono::steady_clock::now();
+	
+	while (!HandleEvents())
+	{
+		// Present the newest frame (a vsync present only holds up this thread)
+		const TripleBuffer::Frame* frame = frames->Acquire();
+		
+		if (frame)
+		{
+			display->Draw(frame);
+			presentTime = std::chrono::steady_clock::now();
+		}
+		
+		// Ready for another once this one was up for a refresh (vsync already waited)
+		if (display->IsVsync() || std::chrono::steady_clock::now() - presentTime >= refreshTime)
+			frameWanted = true;
+		
+		if (!frame)
+			SDL_Delay(1);
+	}
+	
+	quit = true;
+	thread.join();
+}
+
+void Frontend::Run()
+{
+	int frameSkip = gameboy->GetFrameSkip();
+	pacer.Reset();
+	
+	// Movies only have the buttons of every frame, run-ahead would drop
+	// what ahead frames read
+	bool queued = !movie && !runAhead;
+	gameboy->SetInputQueue((queued)? &inputQueue : NULL);
+	
+	while (!quit)
+	{
+		if (opcodeDebug.exchange(false))
+			gameboy->GetDebug()->opcodes = true;
+		
+		// Unthrottled, only draw (or only publish) what the display can show
+		pacer.SetTurbo(turbo);
+		decimating = !pacer.IsThrottled();
+		
+		// Drawn on demand unthrottled, and running ahead (only the frame shown).
+		// A capture needs every frame drawn, skipped ones would be the last
+		// drawn frame again
+		bool ahead = runAhead && !decimating;
+		int skip = ((decimating && turboFrameSkip) || ahead)? 0 : (capture)? 1 : frameSkip;
+		
+		if (gameboy->GetFrameSkip() != skip)
+			gameboy->SetFrameSkip(skip);
+		
+		// Sound only at normal speed (faster, the ring would just overflow)
+		bool realTime = pacer.IsThrottled() && pacer.GetSpeed() == 1;
+		
+		if (audio && playing != realTime)
+		{
+			playing = realTime;
+			
+			if (capture)
+				capture->SetNextSink((playing)? audio : NULL);
+			else
+				gameboy->SetAudioSink((playing)? audio : NULL, audio->GetSampleRate());
+		}
+		
+		// The device's clock never quite matches ours, keep the ring near its target
+		if (playing && !capture)
+			gameboy->SetAudioRate(audio->GetControlledRate());
+		
+		bool wanted = decimating && frameWanted.exchange(false);
+		
+		// Draws the frame after this one (this one was already decided)
+		if (wanted)
+			gameboy->RequestFrame();
+		
+		// Read input late in the frame (the frame just started, it's due a frame from now)
+		if (pollDelay.count() && pacer.IsThrottled())
+			inputQueue.SetDeadline(std::chrono::steady_clock::now() + pollDelay);
+		else
+			inputQueue.ClearDeadline();
+		
+		// Run the core for a frame (from the last rewind state if rewinding)
+		bool rewound = rewinding && rewind && !movie && rewind->StepBack();
+		uint8_t mask = NextInput();
+		
+		// The queue already hands over every change (setting it here too
+		// could undo a tap it latched), but a rewind loaded old buttons
+		if (!queued || rewound)
+			gameboy->SetInput(mask);
+		
+		if (ahead)
+			runAhead->RunFrame();
+		else
+			gameboy->RunFrame();
+		
+		// Frames replayed while rewinding aren't recorded again
+		if (rewind && !rewound)
+			rewind->OnFrame();
+		
+		if (capture)
+			capture->AddFrame(gameboy->GetFramebuffer());
+		
+		// Hand it to the main thread (skipped frames were never drawn)
+		if (gameboy->IsFrameRendered() && (!decimating || turboFrameSkip || wanted))
+			frames->Publish(gameboy->GetScreen());
+		
+		// Wait until the next frame is due (or the device has played enough)
+		if (playing && audioSync)
+		{
+			audio->Wait();
+			pacer.Reset();
+		}
+		else
+		{
+			pacer.Wait();
+		}
+		
+		if (frameLimiterDebug && ahead)
+			printf("LATE: %.1f us, run-ahead save/load: %.1f us\n", pacer.GetLateness() / 1000.0, runAhead->GetStateMicros());
+		else if (frameLimiterDebug && pacer.IsThrottled())
+			printf("LATE: %.1f us\n", pacer.GetLateness() / 1000.0);
+	}
+}
+
+bool Frontend::HandleEvents()
+{
+	SDL_Event e;
+	
+	while (SDL_PollEvent(&e) != 0)
+	{
+		if (e.type == SDL_QUIT)
+		{
+			return true;
+		}
+		else if (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP)
+		{
+			// Held keys repeat
+			if (!e.key.repeat)
+				OnKey(e.key.keysym.sym, e.type == SDL_KEYDOWN);
+		}
+		else if (e.type == SDL_CONTROLLERBUTTONDOWN || e.type == SDL_CONTROLLERBUTTONUP)
+		{
+			OnButton(e.cbutton.button, e.type == SDL_CONTROLLERBUTTONDOWN);
+		}
+		else if (e.type == SDL_CONTROLLERAXISMOTION)
+		{
+			OnAxis(e.caxis.axis, e.caxis.value);
+		}
+		else if (e.type == SDL_CONTROLLERDEVICEADDED)
+		{
+			OnControllerAdded(e.cdevice.which);
+		}
+		else if (e.type == SDL_CONTROLLERDEVICEREMOVED)
+		{
+			OnControllerRemoved(e.cdevice.which);
+		}
+		else
+		{
+			display->OnEvent(&e);
+		}
+	}
+	
+	return false;
+}
+
+uint8_t Frontend::NextInput()
+{
+	// Input is only given to the core right before a frame
+	uint8_t mask = input;
+	
+	if (movie && recording)
+		movie->AddFrame(mask);
+	else if (movie)
+		mask = movie->GetInput(movieFrame);
+	
+	movieFrame++;
+	return mask;
+}
+
+void Frontend::OnKey(SDL_Keycode key, bool value)
+{
+	OnAction(inputMap.GetKeyAction(key), value, keyButtons);
+}
+
+void Frontend::OnButton(int button, bool value)
+{
+	OnAction(inputMap.GetButtonAction(button), value, padButtons);
+}
+
+void Frontend::OnAxis(int axis, int value)
+{
+	// The left stick is another d-pad
+	uint8_t negative, positive;
+	
+	if (axis == SDL_CONTROLLER_AXIS_LEFTX)
+	{
+		negative = BUTTON_LEFT;
+		positive = BUTTON_RIGHT;
+	}
+	else if (axis == SDL_CONTROLLER_AXIS_LEFTY)
+	{
+		negative = BUTTON_UP;
+		positive = BUTTON_DOWN;
+	}
+	else
+	{
+		return;
+	}
+	
+	stickButtons &= ~(negative | positive);
+	
+	if (value <= -STICK_THRESHOLD)
+		stickButtons |= negative;
+	else if (value >= STICK_THRESHOLD)
+		stickButtons |= positive;
+	
+	UpdateInput();
+}
+
+void Frontend::OnAction(InputAction action, bool value, uint8_t& buttons)
+{
+	if (action < ACTION_BUTTONS)
+	{
+		if (value)
+			buttons |= 1 << action;
+		else
+			buttons &= ~(1 << action);
+		
+		UpdateInput();
+		return;
+	}
+	
+	switch (action)
+	{
+		case ACTION_REWIND:
+			rewinding = value;
+			break;
+		case ACTION_TURBO:
+			turbo = value;
+			break;
+		// Debug
+		case ACTION_PRINT_OPCODES:
+			if (value)
+				opcodeDebug = true;
+			break;
+		case ACTION_PRINT_TIMINGS:
+			if (value)
+				frameLimiterDebug = true;
+			break;
+		default:
+			break;
+	}
+}
+
+void Frontend::UpdateInput()
+{
+	uint8_t mask = keyButtons | padButtons | stickButtons;
+	uint8_t changed = mask ^ input;
+	
+	if (!changed)
+		return;
+	
+	input = mask;
+	
+	if (movie)
+		return;
+	
+	for (int i = 0; i < 8; i++)
+	{
+		if (changed & (1 << i))
+			inputQueue.Push(1 << i, (mask & (1 << i)) != 0);
+	}
+}
+
+void Frontend::OnControllerAdded(int index)
+{
+	// Controllers already plugged in are added at startup too
+	SDL_GameController* controller = SDL_GameControllerOpen(index);
+	
+	if (!controller)
+	{
+		printf("Could not open controller %d: %s\n", index, SDL_GetError());
+		return;
+	}
+	
+	controllers.push_back(controller);
+	printf("Controller connected: %s\n", SDL_GameControllerName(controller));
+}
+
+void Frontend::OnControllerRemoved(SDL_JoystickID id)
+{
+	for (size_t i = 0; i < controllers.size(); i++)
+	{
+		if (SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controllers[i])) == id)
+		{
+			SDL_GameControllerClose(controllers[i]);
+			controllers.erase(controllers.begin() + i);
+			break;
+		}
+	}
+	
+	// Let go of whatever it held (buttons of all controllers are one mask)
+	padButtons = 0;
+	stickButtons = 0;
+	UpdateInput();
+}
\ No newline at end of file
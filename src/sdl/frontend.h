@@ -0,0 +1,149 @@
+#ifndef __FRONTEND__
+#define __FRONTEND__
+
+#include <SDL.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include "../gameboy.h"
+#include "display.h"
+#include "audio.h"
+#include "input_map.h"
+#include "../triple_buffer.h"
+#include "frame_pacer.h"
+#include "../rewind.h"
+#include "../run_ahead.h"
+#include "../movie.h"
+#include "../capture.h"
+#include "../input_queue.h"
+
+/*
+ * SDL frontend.
+ * The core runs a frame at a time on an emulation thread, paced to
+ * 59.7275 fps (or a multiple, or unthrottled while tab is held), and
+ * publishes finished frames through a triple buffer.
+ * Unthrottled, only the frames the display can show (one per refresh)
+ * are drawn, the rest are skipped by the PPU.
+ * Sound plays at normal speed only. The sample rate is bent slightly
+ * to keep the audio ring from running dry, and with audio sync the
+ * ring's fill paces the emulation instead of the clock.
+ * The main thread handles SDL events and presents the newest frame,
+ * so neither waits on the other.
+ * Captures go through the emulation thread without ever waiting on
+ * the writer (a capture's sound is at a fixed rate, not bent).
+ * Button events also go straight to the core through a queue, the game
+ * sees them at its next read of JOYP (not with movies, they only have
+ * per frame input). With a poll delay that read waits until that far
+ * into the frame, so input is as fresh as it can be.
+ * Run-ahead shows frames that many frames ahead (throttled only, and
+ * instead of the input queue, ahead frames are thrown away with what
+ * they read).
+ * Keys and controller buttons go through an InputMap (config file),
+ * controllers can come and go while it runs.
+ * Holding backspace rewinds (unless a movie is playing/recording).
+ */
+class Frontend
+{
+	public:
+		// rewindInterval: frames between rewind states (0 = no rewind)
+		// vsync: present in step with the display's refresh
+		// sound: play the Gameboy's sound (false = the APU only runs what games can read)
+		Frontend(GameBoy* gameboy, int rewindInterval = 1, bool vsync = false, bool sound = true);
+		~Frontend();
+		// Plays a movie (from where it starts), or records the input to it
+		void SetMovie(Movie* movie, bool recording);
+		// 1, 2, 4, 8... times normal speed, FramePacer::UNTHROTTLED = as fast as possible
+		void SetSpeed(int speed);
+		// Unthrottled, skip drawing frames that won't be shown (on by default),
+		// otherwise every frame is drawn and only presenting is decimated
+		void SetTurboFrameSkip(bool enabled);
+		// Paced by the audio device instead of the clock (at normal speed)
+		void SetAudioSync(bool enabled);
+		// Records what's shown and heard to a file (see capture.h)
+		bool StartCapture(const char* filename);
+		// The game's first input read of a frame waits until ms into it (0 = no waiting)
+		void SetPollDelay(int ms);
+		// Frames to run ahead (0 = off, see RunAhead)
+		void SetRunAhead(int frames);
+		// Rebinds keys and controller buttons (see InputMap), false if the file can't be read
+		bool LoadInputMap(const char* filename);
+		// Presents until the window is closed (the core runs on its own thread)
+		void Loop();
+	private:
+		GameBoy* gameboy;
+		Display* display;
+		Audio* audio;
+		TripleBuffer* frames;
+		
+		// EMULATION THREAD
+		std::thread thread;
+		Rewind* rewind;
+		RunAhead* runAhead;
+		
+		Movie* movie;
+		bool recording;
+		int movieFrame;
+		
+		Capture* capture;
+		
+		std::chrono::microseconds pollDelay;
+		
+		FramePacer pacer;
+		
+		// Unthrottled, frames are drawn on demand
+		bool turboFrameSkip;
+		bool decimating;
+		
+		bool audioSync;
+		// The core's sound goes to the audio device
+		bool playing;
+		
+		void Run();
+		uint8_t NextInput();
+		
+		// MAIN THREAD
+		InputMap inputMap;
+		std::vector<SDL_GameController*> controllers;
+		
+		// Buttons held on the keyboard, controller buttons and sticks (BUTTON_* masks)
+		uint8_t keyButtons;
+		uint8_t padButtons;
+		uint8_t stickButtons;
+		
+		// When the last frame was presented
+		std::chrono::steady_clock::time_point presentTime;
+		
+		bool HandleEvents();
+		void OnKey(SDL_Keycode key, bool value);
+		void OnButton(int button, bool value);
+		void OnAxis(int axis, int value);
+		void OnAction(InputAction action, bool value, uint8_t& buttons);
+		// Hands changed buttons to the core
+		void UpdateInput();
+		void OnControllerAdded(int index);
+		void OnControllerRemoved(SDL_JoystickID id);
+		
+		// EITHER (set by the main thread)
+		std::atomic<bool> quit;
+		
+		// Held buttons (BUTTON_* mask)
+		std::atomic<uint8_t> input;
+		// Presses and releases as they happen
+		InputQueue inputQueue;
+		
+		// Rewind is held (backspace)
+		std::atomic<bool> rewinding;
+		
+		// Turbo is held (tab)
+		std::atomic<bool> turbo;
+		
+		// The main thread is ready to show another frame
+		std::atomic<bool> frameWanted;
+		
+		// Print opcodes (F1), frame limiter timings (F2)
+		std::atomic<bool> opcodeDebug;
+		std::atomic<bool> frameLimiterDebug;
+};
+
+#endif
\ No newline at end of file
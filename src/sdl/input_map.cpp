@@ -0,0 +1,252 @@
+#include "input_map.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+// Names in config files (in InputAction order)
+const char* ACTION_NAMES[ACTION_COUNT]
+{
+	"right",
+	"left",
+	"up",
+	"down",
+	"a",
+	"b",
+	"select",
+	"start",
+	"rewind",
+	"turbo",
+	"opcodes",
+	"timings",
+};
+
+struct KeyBinding
+{
+	SDL_Keycode key;
+	InputAction action;
+};
+
+struct ButtonBinding
+{
+	SDL_GameControllerButton button;
+	InputAction action;
+};
+
+const KeyBinding DEFAULT_KEYS[]
+{
+	{ SDLK_RIGHT, ACTION_RIGHT },
+	{ SDLK_LEFT, ACTION_LEFT },
+	{ SDLK_UP, ACTION_UP },
+	{ SDLK_DOWN, ACTION_DOWN },
+	{ SDLK_z, ACTION_A },
+	{ SDLK_x, ACTION_B },
+	{ SDLK_a, ACTION_SELECT },
+	{ SDLK_s, ACTION_START },
+	{ SDLK_BACKSPACE, ACTION_REWIND },
+	{ SDLK_TAB, ACTION_TURBO },
+	{ SDLK_F1, ACTION_PRINT_OPCODES },
+	{ SDLK_F2, ACTION_PRINT_TIMINGS },
+};
+
+// A and B where they are on a Gameboy (B on the left)
+const ButtonBinding DEFAULT_BUTTONS[]
+{
+	{ SDL_CONTROLLER_BUTTON_DPAD_RIGHT, ACTION_RIGHT },
+	{ SDL_CONTROLLER_BUTTON_DPAD_LEFT, ACTION_LEFT },
+	{ SDL_CONTROLLER_BUTTON_DPAD_UP, ACTION_UP },
+	{ SDL_CONTROLLER_BUTTON_DPAD_DOWN, ACTION_DOWN },
+	{ SDL_CONTROLLER_BUTTON_B, ACTION_A },
+	{ SDL_CONTROLLER_BUTTON_A, ACTION_B },
+	{ SDL_CONTROLLER_BUTTON_BACK, ACTION_SELECT },
+	{ SDL_CONTROLLER_BUTTON_START, ACTION_START },
+	{ SDL_CONTROLLER_BUTTON_LEFTSHOULDER, ACTION_REWIND },
+	{ SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, ACTION_TURBO },
+};
+
+// Cuts the spaces off both ends
+static char* Trim(char* text)
+{
+	while (isspace((unsigned char)*text))
+		text++;
+	
+	char* end = text + strlen(text);
+	
+	while (end > text && isspace((unsigned char)end[-1]))
+		end--;
+	
+	*end = 0;
+	return text;
+}
+
+InputMap::InputMap()
+{
+	Reset();
+}
+
+void InputMap::Reset()
+{
+	memset(keys, ACTION_NONE, sizeof(keys));
+	memset(buttons, ACTION_NONE, sizeof(buttons));
+	
+	for (size_t i = 0; i < sizeof(DEFAULT_KEYS) / sizeof(DEFAULT_KEYS[0]); i++)
+		BindKey(DEFAULT_KEYS[i].key, DEFAULT_KEYS[i].action);
+	
+	for (size_t i = 0; i < sizeof(DEFAULT_BUTTONS) / sizeof(DEFAULT_BUTTONS[0]); i++)
+		BindButton(DEFAULT_BUTTONS[i].button, DEFAULT_BUTTONS[i].action);
+}
+
+bool InputMap::Load(const char* filename)
+{
+	FILE* file = fopen(filename, "r");
+	
+	if (!file)
+		return false;
+	
+	// Actions the file has already unbound (keys, buttons)
+	bool cleared[2][ACTION_COUNT] = {};
+	char line[256];
+	int number = 0;
+	
+	while (fgets(line, sizeof(line), file))
+	{
+		number++;
+		char* text = Trim(line);
+		
+		if (!*text || *text == '#')
+			continue;
+		
+		char* equals = strchr(text, '=');
+		
+		if (!equals)
+		{
+			printf("%s:%d: expected name = value\n", filename, number);
+			continue;
+		}
+		
+		*equals = 0;
+		char* name = Trim(text);
+		char* value = Trim(equals + 1);
+		
+		if (strcmp(name, "mappings") == 0)
+		{
+			if (SDL_GameControllerAddMappingsFromFile(value) < 0)
+				printf("%s:%d: could not read %s\n", filename, number, value);
+			
+			continue;
+		}
+		
+		bool pad = strncmp(name, "pad.", 4) == 0;
+		InputAction action = GetAction((pad)? name + 4 : name);
+		
+		if (action == ACTION_NONE)
+		{
+			printf("%s:%d: unknown action %s\n", filename, number, name);
+			continue;
+		}
+		
+		if (pad)
+		{
+			SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString(value);
+			
+			if (button == SDL_CONTROLLER_BUTTON_INVALID)
+			{
+				printf("%s:%d: unknown controller button %s\n", filename, number, value);
+				continue;
+			}
+			
+			if (!cleared[1][action])
+				ClearButtons(action);
+			
+			cleared[1][action] = true;
+			BindButton(button, action);
+		}
+		else
+		{
+			SDL_Keycode key = SDL_GetKeyFromName(value);
+			
+			if (key == SDLK_UNKNOWN || GetKeySlot(key) < 0)
+			{
+				printf("%s:%d: unknown key %s\n", filename, number, value);
+				continue;
+			}
+			
+			if (!cleared[0][action])
+				ClearKeys(action);
+			
+			cleared[0][action] = true;
+			BindKey(key, action);
+		}
+	}
+	
+	fclose(file);
+	return true;
+}
+
+InputAction InputMap::GetKeyAction(SDL_Keycode key)
+{
+	int slot = GetKeySlot(key);
+	return (slot >= 0)? (InputAction)keys[slot] : ACTION_NONE;
+}
+
+InputAction InputMap::GetButtonAction(int button)
+{
+	if (button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX)
+		return ACTION_NONE;
+	
+	return (InputAction)buttons[button];
+}
+
+void InputMap::BindKey(SDL_Keycode key, InputAction action)
+{
+	int slot = GetKeySlot(key);
+	
+	if (slot >= 0)
+		keys[slot] = action;
+}
+
+void InputMap::BindButton(int button, InputAction action)
+{
+	if (button >= 0 && button < SDL_CONTROLLER_BUTTON_MAX)
+		buttons[button] = action;
+}
+
+InputAction InputMap::GetAction(const char* name)
+{
+	for (int i = 0; i < ACTION_COUNT; i++)
+	{
+		if (strcmp(name, ACTION_NAMES[i]) == 0)
+			return (InputAction)i;
+	}
+	
+	return ACTION_NONE;
+}
+
+int InputMap::GetKeySlot(SDL_Keycode key)
+{
+	// Keys without a character are their scancode with a flag set
+	if (key & SDLK_SCANCODE_MASK)
+	{
+		int scancode = key & ~SDLK_SCANCODE_MASK;
+		return (scancode < SDL_NUM_SCANCODES)? 256 + scancode : -1;
+	}
+	
+	return (key >= 0 && key < 256)? key : -1;
+}
+
+void InputMap::ClearKeys(InputAction action)
+{
+	for (int i = 0; i < KEY_SLOTS; i++)
+	{
+		if (keys[i] == action)
+			keys[i] = ACTION_NONE;
+	}
+}
+
+void InputMap::ClearButtons(InputAction action)
+{
+	for (int i = 0; i < SDL_CONTROLLER_BUTTON_MAX; i++)
+	{
+		if (buttons[i] == action)
+			buttons[i] = ACTION_NONE;
+	}
+}
\ No newline at end of file
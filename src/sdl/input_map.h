@@ -0,0 +1,77 @@
+#ifndef __INPUT_MAP__
+#define __INPUT_MAP__
+
+#include <SDL.h>
+#include <stdint.h>
+
+// What a key or controller button does: a Gameboy button (the BUTTON_*
+// bit, in the same order), or something for the frontend
+enum InputAction
+{
+	ACTION_RIGHT,
+	ACTION_LEFT,
+	ACTION_UP,
+	ACTION_DOWN,
+	ACTION_A,
+	ACTION_B,
+	ACTION_SELECT,
+	ACTION_START,
+	ACTION_REWIND,
+	ACTION_TURBO,
+	ACTION_PRINT_OPCODES,
+	ACTION_PRINT_TIMINGS,
+	ACTION_COUNT,
+	ACTION_NONE = 0xFF
+};
+
+// Actions below this are Gameboy buttons
+const int ACTION_BUTTONS = 8;
+
+/*
+ * Key and controller bindings.
+ * Looking one up is a table index (keycodes are folded into a small
+ * range), nothing is searched per event.
+ * Starts with the defaults, a config file rebinds actions:
+ *   # Keys by SDL key name, controller buttons by SDL GameController name
+ *   a = X
+ *   pad.a = b
+ *   # Extra controller mappings (SDL_GameControllerDB format)
+ *   mappings = gamecontrollerdb.txt
+ * An action in the file loses its default bindings (for that kind of
+ * input), repeat the line to bind more than one.
+ * Actions: right left up down a b select start rewind turbo opcodes timings
+ */
+class InputMap
+{
+	public:
+		InputMap();
+		// Back to the default bindings
+		void Reset();
+		// Rebinds from a config file, false if it can't be read (bad lines
+		// are reported and skipped)
+		bool Load(const char* filename);
+		
+		// ACTION_NONE if it's not bound
+		InputAction GetKeyAction(SDL_Keycode key);
+		InputAction GetButtonAction(int button);
+		
+		void BindKey(SDL_Keycode key, InputAction action);
+		void BindButton(int button, InputAction action);
+		
+		// ACTION_NONE if it's not one
+		static InputAction GetAction(const char* name);
+	private:
+		// Latin-1 keycodes, then the rest (SDLK_SCANCODE_MASK | scancode)
+		static const int KEY_SLOTS = 256 + SDL_NUM_SCANCODES;
+		
+		uint8_t keys[KEY_SLOTS];
+		uint8_t buttons[SDL_CONTROLLER_BUTTON_MAX];
+		
+		// Table index, -1 if the key can't be bound
+		static int GetKeySlot(SDL_Keycode key);
+		// Unbinds an action
+		void ClearKeys(InputAction action);
+		void ClearButtons(InputAction action);
+};
+
+#endif
\ No newline at end of file
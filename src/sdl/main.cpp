@@ -0,0 +1,175 @@
+#include "frontend.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+int main( int argc, char* args[] )
+{
+	int frameSkip = 1;
+	bool threadedRendering = false;
+	int rewindInterval = 1;
+	bool vsync = false;
+	int speed = 1;
+	bool turboDraw = false;
+	bool sound = true;
+	bool audioSync = false;
+	const char* capturePath = NULL;
+	int pollDelay = 0;
+	int runAhead = 0;
+	const char* configPath = NULL;
+	const char* moviePath = NULL;
+	bool recording = false;
+	const char* filename = NULL;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -frameskip N : only draw 1 of every N frames
+		if (strcmp(args[i], "-frameskip") == 0 && i + 1 < argc)
+			frameSkip = atoi(args[++i]);
+		// -threaded : draw scanlines on a separate thread
+		else if (strcmp(args[i], "-threaded") == 0)
+			threadedRendering = true;
+		// -rewind N : save a rewind state every N frames (0 = off)
+		else if (strcmp(args[i], "-rewind") == 0 && i + 1 < argc)
+			rewindInterval = atoi(args[++i]);
+		// -vsync : present in step with the display's refresh
+		else if (strcmp(args[i], "-vsync") == 0)
+			vsync = true;
+		// -speed N : run at N times normal speed (0 = unthrottled)
+		else if (strcmp(args[i], "-speed") == 0 && i + 1 < argc)
+			speed = atoi(args[++i]);
+		// -turbodraw : unthrottled, still draw frames that won't be shown
+		else if (strcmp(args[i], "-turbodraw") == 0)
+			turboDraw = true;
+		// -audiosync : paced by the audio device instead of the clock
+		else if (strcmp(args[i], "-audiosync") == 0)
+			audioSync = true;
+		// -capture file : record video and sound (.bgbc, or .y4m + .wav)
+		else if (strcmp(args[i], "-capture") == 0 && i + 1 < argc)
+			capturePath = args[++i];
+		// -polldelay ms : the game's input read waits until ms into the frame
+		else if (strcmp(args[i], "-polldelay") == 0 && i + 1 < argc)
+			pollDelay = atoi(args[++i]);
+		// -runahead N : show frames N frames ahead (hides the game's input lag)
+		else if (strcmp(args[i], "-runahead") == 0 && i + 1 < argc)
+			runAhead = atoi(args[++i]);
+		// -config file : key and controller bindings (bettergb.cfg if it's there)
+		else if (strcmp(args[i], "-config") == 0 && i + 1 < argc)
+			configPath = args[++i];
+		// -mute : no sound
+		else if (strcmp(args[i], "-mute") == 0)
+			sound = false;
+		// -play file : play an input movie
+		else if (strcmp(args[i], "-play") == 0 && i + 1 < argc)
+			moviePath = args[++i];
+		// -record file : record the input to a movie
+		else if (strcmp(args[i], "-record") == 0 && i + 1 < argc)
+		{
+			moviePath = args[++i];
+			recording = true;
+		}
+		// Anything else is the ROM
+		else
+			filename = args[i];
+	}
+	
+	#ifdef _WIN32
+	char path[MAX_PATH] = {0};
+	
+	if (!filename)
+	{
+		OPENFILENAME ofn;
+
+		// Get a filename to open
+		ZeroMemory(&ofn, sizeof(OPENFILENAME));
+		ofn.lStructSize = sizeof(OPENFILENAME);
+		ofn.hwndOwner = NULL;
+		ofn.lpstrFilter = "Gameboy/Gameboy Color Games\0*.gb;*.gbc\0\0";
+		ofn.lpstrFile = path;
+		ofn.nMaxFile = MAX_PATH;
+		ofn.lpstrTitle = "Browse";
+		ofn.Flags = OFN_FILEMUSTEXIST;
+		
+		if (GetOpenFileName(&ofn))
+			filename = path;
+	}
+	#endif
+	
+	if (!filename)
+	{
+		printf("Usage: %s [-frameskip N] [-threaded] [-rewind N] [-vsync] [-speed N] [-turbodraw] [-audiosync] [-capture file] [-polldelay ms] [-runahead N] [-config file] [-mute] [-play movie | -record movie] rom.gb\n", args[0]);
+		return 1;
+	}
+	
+	GameBoy gameboy;
+	gameboy.SetFrameSkip(frameSkip);
+	gameboy.SetThreadedRendering(threadedRendering);
+	
+	if (!gameboy.LoadROM(filename))
+	{
+		printf("Could not load %s\n", filename);
+		return 1;
+	}
+	
+	Movie movie;
+	
+	if (moviePath && recording)
+	{
+		if (!movie.Record(&gameboy))
+		{
+			printf("Could not record %s on %s\n", moviePath, filename);
+			return 1;
+		}
+	}
+	else if (moviePath && (!movie.Load(moviePath) || !movie.Play(&gameboy)))
+	{
+		printf("Could not play %s on %s\n", moviePath, filename);
+		return 1;
+	}
+	
+	if ( SDL_Init( SDL_INIT_VIDEO | SDL_INIT_AUDIO ) < 0 )
+	{
+		printf( "SDL could not initialize! SDL_error: %s\n", SDL_GetError() );
+		return 1;
+	}
+	
+	// Controllers are optional
+	if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0)
+		printf("No controller support: %s\n", SDL_GetError());
+	
+	Frontend* frontend = new Frontend(&gameboy, rewindInterval, vsync, sound);
+	
+	frontend->SetSpeed(speed);
+	frontend->SetAudioSync(audioSync);
+	frontend->SetTurboFrameSkip(!turboDraw);
+	frontend->SetPollDelay(pollDelay);
+	frontend->SetRunAhead(runAhead);
+	
+	if (configPath && !frontend->LoadInputMap(configPath))
+		printf("Could not read %s\n", configPath);
+	else if (!configPath)
+		frontend->LoadInputMap("bettergb.cfg");
+	
+	if (capturePath && !frontend->StartCapture(capturePath))
+		printf("Could not write %s\n", capturePath);
+	
+	if (moviePath)
+		frontend->SetMovie(&movie, recording);
+	
+	// Enter game loop
+	frontend->Loop();
+	
+	delete frontend;
+	SDL_Quit();
+	
+	if (moviePath && recording && !movie.Save(moviePath))
+	{
+		printf("Could not write %s\n", moviePath);
+		return 1;
+	}
+	
+	return 0;
+}
\ No newline at end of file
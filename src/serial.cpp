@@ -0,0 +1,83 @@
+#include "serial.h"
+#include "memory.h"
+
+const int FLAG_SERIAL = 1 << 3;
+
+const int SC_START = 0x80;
+const int SC_FAST = 0x02;
+const int SC_INTERNAL_CLOCK = 0x01;
+
+// 8192 Hz (or 262144 Hz with the CGB fast clock), 8 bits per byte
+const int BYTE_CYCLES = 512 * 8;
+const int FAST_BYTE_CYCLES = 16 * 8;
+
+Serial::Serial(Memory* memory, CPU* cpu)
+{
+	this->memory = memory;
+	this->cpu = cpu;
+	
+	sink = NULL;
+	
+	memory->serial = this;
+}
+
+void Serial::Reset()
+{
+	sb = &memory->io[0x01];
+	sc = &memory->io[0x02];
+	
+	isCGB = memory->cart->isCGB;
+	transferCycles = 0;
+}
+
+void Serial::SaveState(State* state)
+{
+	state->transferCycles = transferCycles;
+}
+
+void Serial::LoadState(const State* state)
+{
+	transferCycles = state->transferCycles;
+}
+
+void Serial::SetSink(SerialSink* sink)
+{
+	this->sink = sink;
+}
+
+void Serial::OnSC(uint8_t data)
+{
+	// Unused bits read as 1 (bit 1 is the CGB clock speed)
+	*sc = data | ((isCGB)? 0x7C : 0x7E);
+	
+	// Start a transfer, if we're providing the clock
+	if ((data & SC_START) && (data & SC_INTERNAL_CLOCK))
+	{
+		transferCycles = (isCGB && (data & SC_FAST))? FAST_BYTE_CYCLES : BYTE_CYCLES;
+	}
+	else
+	{
+		transferCycles = 0;
+	}
+}
+
+void Serial::Step()
+{
+	if (!transferCycles)
+		return;
+	
+	// Clock comes from the CPU, so double speed mode doubles it too
+	transferCycles -= cpu->lastInstructionCycles;
+	
+	if (transferCycles > 0)
+		return;
+	
+	transferCycles = 0;
+	
+	// Swap bytes with the other side
+	*sb = (sink)? sink->OnSerialByte(*sb) : 0xFF;
+	
+	// Done
+	*sc &= ~SC_START;
+	memory->RequestInterrupt(FLAG_SERIAL);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef __SERIAL__
+#define __SERIAL__
+
+#include "cpu.h"
+#include "aligned.h"
+
+class Memory;
+
+/*
+ * Whatever is on the other end of the link cable.
+ * Gets every byte sent, returns the byte sent back.
+ */
+class SerialSink
+{
+	public:
+		virtual ~SerialSink() {}
+		virtual uint8_t OnSerialByte(uint8_t data) = 0;
+};
+
+/*
+ * Serial port (SB FF01, SC FF02).
+ * Only the internal clock is emulated, so without a sink a
+ * transfer still finishes and reads back 0xFF (nothing connected).
+ */
+class Serial : public CacheAligned
+{
+	public:
+		// Savestate block (plain data, see savestate.h)
+		struct State
+		{
+			int32_t transferCycles;
+		};
+		
+		Serial(Memory* memory, CPU* cpu);
+		void Reset();
+		void SaveState(State* state);
+		void LoadState(const State* state);
+		// Called after every CPU step
+		void Step();
+		void SetSink(SerialSink* sink);
+		void OnSC(uint8_t data);
+	
+	private:
+		Memory* memory;
+		CPU* cpu;
+		SerialSink* sink;
+		
+		uint8_t* sb;
+		uint8_t* sc;
+		
+		bool isCGB;
+		// CPU cycles until the current transfer is done (0 = idle)
+		int transferCycles;
+};
+
+#endif
\ No newline at end of file
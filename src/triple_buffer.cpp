@@ -0,0 +1,56 @@
+#include "triple_buffer.h"
+#include <string.h>
+
+const int FRESH = 4;
+const int INDEX_MASK = 3;
+
+TripleBuffer::TripleBuffer()
+{
+	memset(frames, 0, sizeof(frames));
+	memset(lineVersion, 0, sizeof(lineVersion));
+	version = 0;
+	
+	back = 0;
+	middle.store(1);
+	front = 2;
+}
+
+void TripleBuffer::Publish(Screen* screen)
+{
+	// Lines changed since the last publish get a new version
+	if (screen->IsDirty())
+	{
+		version++;
+		
+		for (int y = 0; y < Screen::HEIGHT; y++)
+		{
+			if (screen->IsLineDirty(y))
+				lineVersion[y] = version;
+		}
+		
+		screen->ClearDirty();
+	}
+	
+	// The back frame is a couple of frames old, only bring its stale lines up to date
+	Frame* frame = &frames[back];
+	
+	for (int y = 0; y < Screen::HEIGHT; y++)
+	{
+		if (frame->lineVersion[y] != lineVersion[y])
+		{
+			memcpy(&frame->pixels[y * Screen::WIDTH], &screen->pixels[y * Screen::WIDTH], Screen::WIDTH * sizeof(uint32_t));
+			frame->lineVersion[y] = lineVersion[y];
+		}
+	}
+	
+	back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+const TripleBuffer::Frame* TripleBuffer::Acquire()
+{
+	if (!(middle.load(std::memory_order_relaxed) & FRESH))
+		return NULL;
+	
+	front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+	return &frames[front];
+}
\ No newline at end of file
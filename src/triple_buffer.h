@@ -0,0 +1,55 @@
+#ifndef __TRIPLE_BUFFER__
+#define __TRIPLE_BUFFER__
+
+#include <stdint.h>
+#include <atomic>
+#include "screen.h"
+#include "aligned.h"
+
+/*
+ * Finished frames handed from the emulation thread to the presentation
+ * thread without locks.
+ * The writer fills the back frame and swaps it with the middle one, the
+ * reader swaps the middle one with its front frame when it's newer.
+ * Neither side ever waits for the other.
+ */
+class TripleBuffer : public CacheAligned
+{
+	public:
+		struct Frame
+		{
+			uint32_t pixels[Screen::WIDTH * Screen::HEIGHT];
+			// Version of each line (changes whenever the line does)
+			uint32_t lineVersion[Screen::HEIGHT];
+		};
+		
+		TripleBuffer();
+		
+		// WRITER
+		// Copies the lines that changed into the back frame and publishes it
+		// (consumes the screen's dirty lines)
+		void Publish(Screen* screen);
+		
+		// READER
+		// The newest published frame, NULL if nothing new since the last call
+		// (stays valid until the next call)
+		const Frame* Acquire();
+		
+	private:
+		Frame frames[3];
+		
+		// Writer's line versions
+		uint32_t version;
+		uint32_t lineVersion[Screen::HEIGHT];
+		int back;
+		
+		// Index of the middle frame (| FRESH if published and not acquired yet)
+		char padding0[64];
+		std::atomic<int> middle;
+		char padding1[64];
+		
+		// Reader's
+		int front;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "xxhash.h"
+#include <string.h>
+
+const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t Rotl(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t Read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static inline uint32_t Read32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME64_2;
+	acc = Rotl(acc, 31);
+	return acc * PRIME64_1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t value)
+{
+	acc ^= Round(0, value);
+	return acc * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t XXH64(const void* data, size_t length, uint64_t seed)
+{
+	const uint8_t* p = (const uint8_t*)data;
+	const uint8_t* end = p + length;
+	uint64_t hash;
+	
+	if (length >= 32)
+	{
+		uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+		uint64_t v2 = seed + PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME64_1;
+		
+		// 4 lanes of 8 bytes
+		const uint8_t* limit = end - 32;
+		
+		do
+		{
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+			p += 32;
+		}
+		while (p <= limit);
+		
+		hash = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+		hash = MergeRound(hash, v1);
+		hash = MergeRound(hash, v2);
+		hash = MergeRound(hash, v3);
+		hash = MergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + PRIME64_5;
+	}
+	
+	hash += length;
+	
+	// The rest
+	while (p + 8 <= end)
+	{
+		hash ^= Round(0, Read64(p));
+		hash = Rotl(hash, 27) * PRIME64_1 + PRIME64_4;
+		p += 8;
+	}
+	
+	if (p + 4 <= end)
+	{
+		hash ^= Read32(p) * PRIME64_1;
+		hash = Rotl(hash, 23) * PRIME64_2 + PRIME64_3;
+		p += 4;
+	}
+	
+	while (p < end)
+	{
+		hash ^= *p * PRIME64_5;
+		hash = Rotl(hash, 11) * PRIME64_1;
+		p++;
+	}
+	
+	// Avalanche
+	hash ^= hash >> 33;
+	hash *= PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= PRIME64_3;
+	hash ^= hash >> 32;
+	
+	return hash;
+}
\ No newline at end of file
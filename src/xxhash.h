@@ -0,0 +1,14 @@
+#ifndef __XXHASH__
+#define __XXHASH__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * xxHash64 (same output as the reference implementation).
+ * Hashes 32 byte stripes in 4 independent lanes, so it runs at
+ * several bytes per cycle.
+ */
+uint64_t XXH64(const void* data, size_t length, uint64_t seed = 0);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,423 @@
+#include "gameboy.h"
+#include "movie.h"
+#include "thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <sys/stat.h>
+
+/*
+ * Runs a manifest of jobs on all cores (one GameBoy per job).
+ * batch [-j threads] [-o dir] manifest
+ *
+ * Manifest: one job per line, '#' starts a comment
+ *   rom=PATH frames=N [input=FILE | movie=FILE] [out=PREFIX] [ram] [hashes] [hashlog] [screenshot]
+ * Values with spaces can be quoted: rom="roms/Zelda LA.gb"
+ *
+ * input: lines of "FRAME MASK", the buttons (BUTTON_* mask) held from FRAME on
+ * movie: an input movie (see movie.h), frames defaults to its length
+ * out: prefix for the artifacts (default: dir/LINE-ROMNAME)
+ *   ram        -> PREFIX.ram    work RAM after the last frame
+ *   hashes     -> PREFIX.hashes "FRAME HASH" for every frame (streamed)
+ *   hashlog    -> PREFIX.hashlog screen and RAM xxHash64 of every frame
+ *                 (binary, see frame_hash.h, compare with hashdiff)
+ *   screenshot -> PREFIX.ppm    the last frame
+ */
+
+struct Job
+{
+	int line;
+	std::string rom;
+	int frames;
+	std::string input;
+	std::string movie;
+	std::string out;
+	bool ram;
+	bool hashes;
+	bool hashlog;
+	bool screenshot;
+};
+
+struct InputChange
+{
+	int frame;
+	uint8_t mask;
+};
+
+std::mutex printMutex;
+
+// Splits a line into tokens (double quotes group)
+std::vector<std::string> Tokenize(const std::string& line)
+{
+	std::vector<std::string> tokens;
+	std::string token;
+	bool quoted = false;
+	bool hasToken = false;
+	
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		char c = line[i];
+		
+		if (c == '"')
+		{
+			quoted = !quoted;
+			hasToken = true;
+		}
+		else if (!quoted && (c == ' ' || c == '\t' || c == '\r' || c == '\n'))
+		{
+			if (hasToken)
+				tokens.push_back(token);
+			
+			token.clear();
+			hasToken = false;
+		}
+		else if (!quoted && c == '#')
+		{
+			break;
+		}
+		else
+		{
+			token += c;
+			hasToken = true;
+		}
+	}
+	
+	if (hasToken)
+		tokens.push_back(token);
+	
+	return tokens;
+}
+
+std::string GetROMName(const std::string& path)
+{
+	size_t slash = path.find_last_of("/\\");
+	std::string name = (slash == std::string::npos)? path : path.substr(slash + 1);
+	size_t dot = name.rfind('.');
+	
+	if (dot != std::string::npos)
+		name = name.substr(0, dot);
+	
+	// Keep file names simple
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		if (name[i] == ' ')
+			name[i] = '_';
+	}
+	
+	return name;
+}
+
+bool ReadManifest(const char* filename, const std::string& outDir, std::vector<Job>& jobs)
+{
+	FILE* file = fopen(filename, "r");
+	
+	if (!file)
+	{
+		fprintf(stderr, "Could not open %s\n", filename);
+		return false;
+	}
+	
+	char buffer[4096];
+	int line = 0;
+	bool ok = true;
+	
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		line++;
+		std::vector<std::string> tokens = Tokenize(buffer);
+		
+		if (tokens.empty())
+			continue;
+		
+		Job job;
+		job.line = line;
+		job.frames = 0;
+		job.ram = false;
+		job.hashes = false;
+		job.hashlog = false;
+		job.screenshot = false;
+		
+		for (size_t i = 0; i < tokens.size(); i++)
+		{
+			const std::string& token = tokens[i];
+			size_t equals = token.find('=');
+			std::string key = token.substr(0, equals);
+			std::string value = (equals == std::string::npos)? "" : token.substr(equals + 1);
+			
+			if (key == "rom") job.rom = value;
+			else if (key == "frames") job.frames = atoi(value.c_str());
+			else if (key == "input") job.input = value;
+			else if (key == "movie") job.movie = value;
+			else if (key == "out") job.out = value;
+			else if (key == "ram") job.ram = true;
+			else if (key == "hashes") job.hashes = true;
+			else if (key == "hashlog") job.hashlog = true;
+			else if (key == "screenshot") job.screenshot = true;
+			else
+			{
+				fprintf(stderr, "%s:%d: unknown option '%s'\n", filename, line, key.c_str());
+				ok = false;
+			}
+		}
+		
+		if (job.rom.empty() || (job.frames <= 0 && job.movie.empty()))
+		{
+			fprintf(stderr, "%s:%d: needs rom= and frames= (or movie=)\n", filename, line);
+			ok = false;
+			continue;
+		}
+		
+		if (job.out.empty())
+			job.out = outDir + "/" + std::to_string(line) + "-" + GetROMName(job.rom);
+		
+		jobs.push_back(job);
+	}
+	
+	fclose(file);
+	return ok;
+}
+
+bool ReadInput(const std::string& filename, std::vector<InputChange>& changes)
+{
+	FILE* file = fopen(filename.c_str(), "r");
+	
+	if (!file)
+		return false;
+	
+	char buffer[256];
+	
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		std::vector<std::string> tokens = Tokenize(buffer);
+		
+		if (tokens.size() < 2)
+			continue;
+		
+		InputChange change;
+		change.frame = atoi(tokens[0].c_str());
+		change.mask = (uint8_t)strtol(tokens[1].c_str(), NULL, 0);
+		changes.push_back(change);
+	}
+	
+	fclose(file);
+	return true;
+}
+
+// Creates every directory leading up to a file
+void MakeParentDirs(const std::string& path)
+{
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		if (path[i] == '/')
+			mkdir(path.substr(0, i).c_str(), 0755);
+	}
+}
+
+uint64_t HashFramebuffer(const uint32_t* pixels)
+{
+	uint64_t hash = 1469598103934665603ULL;
+	
+	for (int i = 0; i < Screen::WIDTH * Screen::HEIGHT; i++)
+	{
+		hash ^= pixels[i];
+		hash *= 1099511628211ULL;
+	}
+	
+	return hash;
+}
+
+bool WriteScreenshot(const std::string& filename, const uint32_t* pixels)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	
+	if (!file)
+		return false;
+	
+	fprintf(file, "P6\n%d %d\n255\n", Screen::WIDTH, Screen::HEIGHT);
+	
+	for (int i = 0; i < Screen::WIDTH * Screen::HEIGHT; i++)
+	{
+		uint8_t rgb[3] = { (uint8_t)(pixels[i] >> 16), (uint8_t)(pixels[i] >> 8), (uint8_t)pixels[i] };
+		fwrite(rgb, 1, 3, file);
+	}
+	
+	fclose(file);
+	return true;
+}
+
+bool WriteRAM(const std::string& filename, GameBoy& gameboy)
+{
+	FILE* file = fopen(filename.c_str(), "wb");
+	
+	if (!file)
+		return false;
+	
+	fwrite(gameboy.GetRAM(), 1, gameboy.GetRAMSize(), file);
+	fclose(file);
+	return true;
+}
+
+// Runs one job, returns an error message (empty if it worked)
+std::string RunJob(const Job& job, int* framesRun)
+{
+	std::vector<InputChange> input;
+	
+	if (!job.input.empty() && !ReadInput(job.input, input))
+		return "could not read " + job.input;
+	
+	Movie movie;
+	bool hasMovie = !job.movie.empty();
+	
+	if (hasMovie && !movie.Load(job.movie.c_str()))
+		return "could not read " + job.movie;
+	
+	GameBoy gameboy;
+	
+	// Only draw what's needed
+	if (!job.hashes && !job.hashlog)
+		gameboy.SetFrameSkip(0);
+	
+	if (!gameboy.LoadROM(job.rom.c_str()))
+		return "could not load " + job.rom;
+	
+	if (hasMovie && !movie.Play(&gameboy))
+		return job.movie + " was made on another ROM";
+	
+	int frames = (job.frames > 0)? job.frames : movie.GetFrameCount();
+	*framesRun = frames;
+	
+	MakeParentDirs(job.out);
+	
+	FrameHashLog hashlog;
+	
+	if (job.hashlog)
+	{
+		if (!hashlog.Open((job.out + ".hashlog").c_str(), gameboy.GetROMHash()))
+			return "could not write " + job.out + ".hashlog";
+		
+		gameboy.SetFrameHashSink(&hashlog);
+	}
+	
+	FILE* hashes = NULL;
+	
+	if (job.hashes)
+	{
+		hashes = fopen((job.out + ".hashes").c_str(), "w");
+		
+		if (!hashes)
+			return "could not write " + job.out + ".hashes";
+	}
+	
+	size_t nextInput = 0;
+	
+	for (int frame = 0; frame < frames; frame++)
+	{
+		if (hasMovie)
+			gameboy.SetInput(movie.GetInput(frame));
+		
+		while (nextInput < input.size() && input[nextInput].frame <= frame)
+			gameboy.SetInput(input[nextInput++].mask);
+		
+		// The frame after the next one is the last
+		if (job.screenshot && frame == frames - 2)
+			gameboy.RequestFrame();
+		
+		gameboy.RunFrame();
+		
+		if (hashes)
+			fprintf(hashes, "%d %016llx\n", frame, (unsigned long long)HashFramebuffer(gameboy.GetFramebuffer()));
+	}
+	
+	if (hashes)
+		fclose(hashes);
+	
+	if (job.hashlog && !hashlog.Close())
+		return "could not write " + job.out + ".hashlog";
+	
+	if (job.ram && !WriteRAM(job.out + ".ram", gameboy))
+		return "could not write " + job.out + ".ram";
+	
+	if (job.screenshot && !WriteScreenshot(job.out + ".ppm", gameboy.GetFramebuffer()))
+		return "could not write " + job.out + ".ppm";
+	
+	return "";
+}
+
+int main(int argc, char* args[])
+{
+	int threads = std::thread::hardware_concurrency();
+	std::string outDir = "batch_out";
+	const char* manifest = NULL;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -j N : worker threads (default: all cores)
+		if (strcmp(args[i], "-j") == 0 && i + 1 < argc)
+			threads = atoi(args[++i]);
+		// -o dir : where artifacts go (unless a job sets out=)
+		else if (strcmp(args[i], "-o") == 0 && i + 1 < argc)
+			outDir = args[++i];
+		else
+			manifest = args[i];
+	}
+	
+	if (!manifest)
+	{
+		printf("Usage: %s [-j threads] [-o dir] manifest\n", args[0]);
+		return 1;
+	}
+	
+	std::vector<Job> jobs;
+	
+	if (!ReadManifest(manifest, outDir, jobs))
+		return 1;
+	
+	std::atomic<int> failed(0);
+	std::atomic<long long> totalFrames(0);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	
+	{
+		ThreadPool pool(threads);
+		
+		for (size_t i = 0; i < jobs.size(); i++)
+		{
+			const Job* job = &jobs[i];
+			
+			pool.Submit([job, &failed, &totalFrames](int worker)
+			{
+				std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
+				int frames = 0;
+				std::string error = RunJob(*job, &frames);
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - jobStart;
+				
+				if (!error.empty())
+					failed++;
+				else
+					totalFrames += frames;
+				
+				std::lock_guard<std::mutex> lock(printMutex);
+				
+				if (error.empty())
+					printf("OK    line %d: %s, %d frames in %.2f s (worker %d)\n", job->line, job->rom.c_str(), frames, elapsed.count(), worker);
+				else
+					printf("ERROR line %d: %s\n", job->line, error.c_str());
+				
+				fflush(stdout);
+			});
+		}
+		
+		pool.Wait();
+	}
+	
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	
+	printf("%d/%d jobs done in %.2f s (%.0f frames/s on %d threads)\n", (int)jobs.size() - failed, (int)jobs.size(),
+		elapsed.count(), totalFrames / elapsed.count(), threads);
+	
+	return (failed > 0)? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "gameboy.h"
+#include "run_ahead.h"
+#include "input_script.h"
+#include "rom_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/resource.h>
+
+/*
+ * Benchmarks the core over a set of ROMs.
+ * bench [-frames N] [-noinput] [-runahead N] [-json] [-o file] [rom|dir]...
+ * Directories are scanned for .gb/.gbc files (default: roms).
+ * Each ROM runs for N frames (no frame limit, no window) with
+ * the scripted input loop, the framebuffer hash lets runs be compared.
+ * Then times saving and loading a savestate of where it ended up.
+ * -runahead runs every frame through RunAhead (fps is real frames,
+ * stresses savestates and skipped frames, the hash is of the frame ahead).
+ */
+
+const int STATE_RUNS = 1000;
+
+struct Result
+{
+	std::string rom;
+	bool loaded;
+	int frames;
+	double seconds;
+	uint64_t instructions;
+	uint64_t frameHash;
+	long peakRSS; // KB (process peak so far)
+	size_t stateSize;
+	double saveMicros; // Per savestate
+	double loadMicros;
+};
+
+// Peak resident set size of this process in KB
+long GetPeakRSS()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+// FNV-1a over the framebuffer
+uint64_t HashFramebuffer(const uint32_t* pixels)
+{
+	uint64_t hash = 1469598103934665603ULL;
+	
+	for (int i = 0; i < Screen::WIDTH * Screen::HEIGHT; i++)
+	{
+		hash ^= pixels[i];
+		hash *= 1099511628211ULL;
+	}
+	
+	return hash;
+}
+
+Result Run(const std::string& rom, int frames, bool scriptedInput, int runAheadFrames)
+{
+	Result result;
+	result.rom = rom;
+	result.frames = frames;
+	result.seconds = 0;
+	result.instructions = 0;
+	result.frameHash = 0;
+	result.stateSize = 0;
+	result.saveMicros = 0;
+	result.loadMicros = 0;
+	
+	GameBoy gameboy;
+	result.loaded = gameboy.LoadROM(rom.c_str());
+	
+	if (result.loaded)
+	{
+		RunAhead runAhead(&gameboy, runAheadFrames);
+		
+		if (runAheadFrames > 0)
+			gameboy.SetFrameSkip(0);
+		
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		
+		for (int frame = 0; frame < frames; frame++)
+		{
+			if (scriptedInput)
+				gameboy.SetInput(GetScriptedInput(frame));
+			
+			runAhead.RunFrame();
+		}
+		
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		
+		result.seconds = elapsed.count();
+		result.instructions = gameboy.GetInstructionCount();
+		result.frameHash = HashFramebuffer(gameboy.GetFramebuffer());
+		
+		// Savestates (after the hash, loading redraws the screen)
+		std::vector<uint8_t> state(gameboy.GetStateSize());
+		
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < STATE_RUNS; i++)
+			result.stateSize = gameboy.SaveState(&state[0], state.size());
+		elapsed = std::chrono::steady_clock::now() - start;
+		result.saveMicros = elapsed.count() * 1e6 / STATE_RUNS;
+		
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < STATE_RUNS; i++)
+			gameboy.LoadState(&state[0], result.stateSize);
+		elapsed = std::chrono::steady_clock::now() - start;
+		result.loadMicros = elapsed.count() * 1e6 / STATE_RUNS;
+	}
+	
+	result.peakRSS = GetPeakRSS();
+	return result;
+}
+
+// Escapes a string for JSON
+std::string Escape(const std::string& s)
+{
+	std::string out;
+	
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		if (s[i] == '"' || s[i] == '\\')
+			out += '\\';
+		out += s[i];
+	}
+	
+	return out;
+}
+
+void PrintJSON(FILE* out, const std::vector<Result>& results, int frames)
+{
+	fprintf(out, "{\n  \"frames\": %d,\n  \"results\": [\n", frames);
+	
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		
+		fprintf(out, "    {\"rom\": \"%s\", \"loaded\": %s", Escape(r.rom).c_str(), r.loaded? "true" : "false");
+		
+		if (r.loaded)
+		{
+			fprintf(out, ", \"frames\": %d, \"seconds\": %.6f, \"fps\": %.2f, \"instructions\": %llu, "
+				"\"instructions_per_sec\": %.0f, \"ns_per_instruction\": %.3f, \"frame_hash\": \"%016llx\", "
+				"\"state_bytes\": %zu, \"state_save_us\": %.3f, \"state_load_us\": %.3f",
+				r.frames, r.seconds, r.frames / r.seconds, (unsigned long long)r.instructions,
+				r.instructions / r.seconds, r.seconds * 1e9 / r.instructions, (unsigned long long)r.frameHash,
+				r.stateSize, r.saveMicros, r.loadMicros);
+		}
+		
+		fprintf(out, ", \"peak_rss_kb\": %ld}%s\n", r.peakRSS, (i + 1 < results.size())? "," : "");
+	}
+	
+	fprintf(out, "  ]\n}\n");
+}
+
+void PrintTable(FILE* out, const std::vector<Result>& results)
+{
+	fprintf(out, "%-28s %10s %10s %10s %10s %8s %8s  %s\n", "ROM", "fps", "MIPS", "ns/instr", "RSS (KB)",
+		"save us", "load us", "hash");
+	
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const Result& r = results[i];
+		
+		if (!r.loaded)
+		{
+			fprintf(out, "%-28s (could not load)\n", r.rom.c_str());
+			continue;
+		}
+		
+		fprintf(out, "%-28s %10.1f %10.2f %10.2f %10ld %8.2f %8.2f  %016llx\n", r.rom.c_str(),
+			r.frames / r.seconds, r.instructions / r.seconds / 1e6,
+			r.seconds * 1e9 / r.instructions, r.peakRSS, r.saveMicros, r.loadMicros,
+			(unsigned long long)r.frameHash);
+	}
+}
+
+int main(int argc, char* args[])
+{
+	int frames = 3600;
+	bool scriptedInput = true;
+	int runAhead = 0;
+	bool json = false;
+	const char* outFile = NULL;
+	std::vector<std::string> roms;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -frames N : emulated frames per ROM
+		if (strcmp(args[i], "-frames") == 0 && i + 1 < argc)
+			frames = atoi(args[++i]);
+		// -noinput : don't press any buttons
+		else if (strcmp(args[i], "-noinput") == 0)
+			scriptedInput = false;
+		// -runahead N : run N frames ahead
+		else if (strcmp(args[i], "-runahead") == 0 && i + 1 < argc)
+			runAhead = atoi(args[++i]);
+		// -json : print JSON instead of a table
+		else if (strcmp(args[i], "-json") == 0)
+			json = true;
+		// -o file : write JSON to a file
+		else if (strcmp(args[i], "-o") == 0 && i + 1 < argc)
+			outFile = args[++i];
+		else
+			AddROMs(args[i], roms);
+	}
+	
+	if (roms.empty())
+		AddROMs("roms", roms);
+	
+	std::vector<Result> results;
+	
+	for (size_t i = 0; i < roms.size(); i++)
+		results.push_back(Run(roms[i], frames, scriptedInput, runAhead));
+	
+	if (json)
+		PrintJSON(stdout, results, frames);
+	else
+		PrintTable(stdout, results);
+	
+	if (outFile)
+	{
+		FILE* out = fopen(outFile, "w");
+		
+		if (!out)
+		{
+			fprintf(stderr, "Could not write %s\n", outFile);
+			return 1;
+		}
+		
+		PrintJSON(out, results, frames);
+		fclose(out);
+	}
+	
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "capture.h"
+#include "delta.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/*
+ * Converts a capture (see capture.h) to Y4M video and a WAV.
+ * capture2y4m capture.bgbc out.y4m out.wav
+ * Dropped frames are shown for longer, so the video stays in step with
+ * the sound.
+ */
+
+int main(int argc, char* args[])
+{
+	if (argc < 4)
+	{
+		printf("Usage: %s capture.bgbc out.y4m out.wav\n", args[0]);
+		return 1;
+	}
+	
+	FILE* in = fopen(args[1], "rb");
+	CaptureHeader header;
+	
+	if (!in || fread(&header, sizeof(header), 1, in) != 1 || header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION ||
+		header.width != Screen::WIDTH || header.height != Screen::HEIGHT)
+	{
+		printf("Could not read %s\n", args[1]);
+		return 1;
+	}
+	
+	FILE* video = fopen(args[2], "wb");
+	FILE* sound = fopen(args[3], "wb");
+	
+	if (!video || !sound || !WriteY4MHeader(video, header.clockRate, header.frameClocks) || !WriteWAVHeader(sound, header.sampleRate, 0))
+	{
+		printf("Could not write %s / %s\n", args[2], args[3]);
+		return 1;
+	}
+	
+	const size_t pixelBytes = Screen::WIDTH * Screen::HEIGHT * sizeof(uint32_t);
+	std::vector<uint32_t> pixels(Screen::WIDTH * Screen::HEIGHT, 0);
+	std::vector<uint8_t> data;
+	bool ok = true;
+	long frames = 0, dropped = 0;
+	uint64_t nextFrame = 0, samples = 0, lostSamples = 0;
+	
+	CaptureChunk chunk;
+	
+	while (ok && fread(&chunk, sizeof(chunk), 1, in) == 1)
+	{
+		data.resize(chunk.size);
+		
+		if (chunk.size && fread(&data[0], chunk.size, 1, in) != 1)
+		{
+			printf("Truncated at frame %ld\n", frames);
+			break;
+		}
+		
+		if (chunk.type == CAPTURE_SOUND)
+		{
+			// Silence for sound that was lost
+			if (chunk.time > samples)
+			{
+				std::vector<int16_t> silence((chunk.time - samples) * 2, 0);
+				ok = fwrite(&silence[0], silence.size() * sizeof(int16_t), 1, sound) == 1;
+				lostSamples += chunk.time - samples;
+				samples = chunk.time;
+			}
+			
+			ok = ok && (!chunk.size || fwrite(&data[0], chunk.size, 1, sound) == 1);
+			samples += chunk.size / 4;
+			continue;
+		}
+		
+		// Dropped frames: the last one stays up until this one
+		for (; frames && nextFrame < chunk.time; nextFrame++, dropped++)
+			ok = ok && WriteY4MFrame(video, &pixels[0]);
+		
+		if (chunk.type == CAPTURE_KEYFRAME && chunk.size == pixelBytes)
+			memcpy(&pixels[0], &data[0], pixelBytes);
+		else if (chunk.type != CAPTURE_DELTA || !ApplyDelta(&data[0], chunk.size, (uint8_t*)&pixels[0], pixelBytes))
+		{
+			printf("Bad chunk at frame %llu\n", (unsigned long long)chunk.time);
+			ok = false;
+			break;
+		}
+		
+		ok = ok && WriteY4MFrame(video, &pixels[0]);
+		nextFrame = chunk.time + 1;
+		frames++;
+	}
+	
+	ok = WriteWAVHeader(sound, header.sampleRate, samples) && ok;
+	ok = fclose(video) == 0 && ok;
+	ok = fclose(sound) == 0 && ok;
+	fclose(in);
+	
+	printf("%ld frames (%ld dropped), %llu samples (%llu lost)\n", frames, dropped, (unsigned long long)samples, (unsigned long long)lostSamples);
+	return (ok)? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "gameboy.h"
+#include <stdio.h>
+#include <vector>
+
+/*
+ * Checks that frame hashes cover HRAM (run by ctest).
+ * hashcheck
+ * Runs two tiny ROMs that only differ in the value they write to HRAM
+ * (FF90): the screens have to hash the same, the RAM hashes must not.
+ */
+
+class LastHash : public FrameHashSink
+{
+	public:
+		FrameHash hash;
+		
+		void OnFrameHash(const FrameHash& hash) override
+		{
+			this->hash = hash;
+		}
+};
+
+// Writes value to FF90 once, then loops
+FrameHash Run(uint8_t value)
+{
+	std::vector<uint8_t> rom(0x8000, 0x00);
+	
+	// Entry point: jp 0x150
+	rom[0x101] = 0xC3;
+	rom[0x102] = 0x50;
+	rom[0x103] = 0x01;
+	
+	// ld a, value; ldh (0x90), a; jr -2
+	const uint8_t code[] = { 0x3E, value, 0xE0, 0x90, 0x18, 0xFE };
+	
+	for (size_t i = 0; i < sizeof(code); i++)
+		rom[0x150 + i] = code[i];
+	
+	GameBoy gameboy;
+	LastHash sink;
+	gameboy.LoadROM(&rom[0], rom.size());
+	gameboy.SetFrameHashSink(&sink);
+	gameboy.RunFrame();
+	gameboy.RunFrame();
+	return sink.hash;
+}
+
+int main(int argc, char* args[])
+{
+	FrameHash a = Run(0x12);
+	FrameHash b = Run(0x34);
+	FrameHash c = Run(0x12);
+	
+	if (a.screen != b.screen || a.ram != c.ram)
+	{
+		printf("FAILED: the same run hashes differently\n");
+		return 1;
+	}
+	
+	if (a.ram == b.ram)
+	{
+		printf("FAILED: an HRAM write doesn't change the RAM hash\n");
+		return 1;
+	}
+	
+	printf("Passed\n");
+	return 0;
+}
\ No newline at end of file
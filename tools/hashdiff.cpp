@@ -0,0 +1,148 @@
+#include "frame_hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+
+/*
+ * Compares the frame hash logs of two runs (see frame_hash.h).
+ * hashdiff a.hashlog b.hashlog
+ * hashdiff dirA dirB : every .hashlog in dirA against the same name in dirB
+ * Prints the first frame where the screens and the RAM differ,
+ * exits with 1 if anything does.
+ */
+
+const int CHUNK_FRAMES = 4096;
+
+struct LogFile
+{
+	FILE* file;
+	FrameHashLogHeader header;
+	
+	bool Open(const std::string& path)
+	{
+		file = fopen(path.c_str(), "rb");
+		
+		if (!file)
+			return false;
+		
+		if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != HASHLOG_MAGIC || header.version != HASHLOG_VERSION)
+		{
+			fclose(file);
+			file = NULL;
+			return false;
+		}
+		
+		return true;
+	}
+};
+
+// Returns true if the logs match
+bool Compare(const std::string& a, const std::string& b, const std::string& name)
+{
+	LogFile logA, logB;
+	
+	if (!logA.Open(a) || !logB.Open(b))
+	{
+		printf("%-32s could not read %s\n", name.c_str(), logA.file? b.c_str() : a.c_str());
+		
+		if (logA.file)
+			fclose(logA.file);
+		return false;
+	}
+	
+	std::vector<FrameHash> chunkA(CHUNK_FRAMES), chunkB(CHUNK_FRAMES);
+	long screenDiff = -1, ramDiff = -1;
+	long framesA = 0, framesB = 0;
+	
+	while (true)
+	{
+		size_t readA = fread(&chunkA[0], sizeof(FrameHash), CHUNK_FRAMES, logA.file);
+		size_t readB = fread(&chunkB[0], sizeof(FrameHash), CHUNK_FRAMES, logB.file);
+		size_t count = std::min(readA, readB);
+		
+		for (size_t i = 0; i < count && (screenDiff < 0 || ramDiff < 0); i++)
+		{
+			if (screenDiff < 0 && chunkA[i].screen != chunkB[i].screen)
+				screenDiff = chunkA[i].frame;
+			if (ramDiff < 0 && chunkA[i].ram != chunkB[i].ram)
+				ramDiff = chunkA[i].frame;
+		}
+		
+		framesA += readA;
+		framesB += readB;
+		
+		if (readA < (size_t)CHUNK_FRAMES || readB < (size_t)CHUNK_FRAMES)
+			break;
+	}
+	
+	fclose(logA.file);
+	fclose(logB.file);
+	
+	bool same = screenDiff < 0 && ramDiff < 0 && framesA == framesB && logA.header.romHash == logB.header.romHash;
+	
+	if (same)
+	{
+		printf("%-32s same (%ld frames)\n", name.c_str(), framesA);
+		return true;
+	}
+	
+	printf("%-32s DIFFERENT:", name.c_str());
+	if (logA.header.romHash != logB.header.romHash)
+		printf(" other ROM");
+	if (screenDiff >= 0)
+		printf(" screen from frame %ld", screenDiff);
+	if (ramDiff >= 0)
+		printf(" RAM from frame %ld", ramDiff);
+	if (framesA != framesB)
+		printf(" %ld vs %ld frames", framesA, framesB);
+	printf("\n");
+	
+	return false;
+}
+
+bool IsHashLog(const std::string& name)
+{
+	const std::string ext = ".hashlog";
+	return name.size() > ext.size() && name.compare(name.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+int main(int argc, char* args[])
+{
+	if (argc != 3)
+	{
+		printf("Usage: %s a.hashlog b.hashlog | dirA dirB\n", args[0]);
+		return 2;
+	}
+	
+	DIR* dir = opendir(args[1]);
+	
+	// Two files
+	if (!dir)
+		return Compare(args[1], args[2], args[1])? 0 : 1;
+	
+	std::vector<std::string> names;
+	struct dirent* entry;
+	
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (IsHashLog(entry->d_name))
+			names.push_back(entry->d_name);
+	}
+	
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+	
+	int different = 0;
+	
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (!Compare(std::string(args[1]) + "/" + names[i], std::string(args[2]) + "/" + names[i], names[i]))
+			different++;
+	}
+	
+	printf("%d/%d runs match\n", (int)names.size() - different, (int)names.size());
+	return (different == 0)? 0 : 1;
+}
\ No newline at end of file
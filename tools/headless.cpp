@@ -0,0 +1,154 @@
+#include "gameboy.h"
+#include "input_script.h"
+#include "movie.h"
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+/*
+ * Plays ROMs without a window (used as the PGO training run).
+ * headless [-frames N] [-movie file | -record file] [-hashlog dir] [-capture dir] rom...
+ * ROMs that can't be loaded are skipped, fails if none could be.
+ * -movie plays an input movie (for as long as it is) instead of the
+ * scripted input, -record saves the scripted input as one.
+ * -hashlog writes dir/ROMNAME.hashlog (frame hashes, see hashdiff).
+ * -capture writes dir/ROMNAME.bgbc (video and sound, see capture.h),
+ * waiting for the writer instead of dropping frames.
+ */
+
+int main(int argc, char* args[])
+{
+	int frames = 3600;
+	int played = 0;
+	const char* moviePath = NULL;
+	const char* recordPath = NULL;
+	const char* hashlogDir = NULL;
+	const char* captureDir = NULL;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -frames N : frames to run each ROM for
+		if (strcmp(args[i], "-frames") == 0 && i + 1 < argc)
+		{
+			frames = atoi(args[++i]);
+			continue;
+		}
+		
+		// -movie file : play an input movie
+		if (strcmp(args[i], "-movie") == 0 && i + 1 < argc)
+		{
+			moviePath = args[++i];
+			continue;
+		}
+		
+		// -hashlog dir : write the frame hashes of every ROM to dir
+		if (strcmp(args[i], "-hashlog") == 0 && i + 1 < argc)
+		{
+			hashlogDir = args[++i];
+			continue;
+		}
+		
+		// -capture dir : capture every ROM to dir
+		if (strcmp(args[i], "-capture") == 0 && i + 1 < argc)
+		{
+			captureDir = args[++i];
+			continue;
+		}
+		
+		// -record file : record the input to a movie
+		if (strcmp(args[i], "-record") == 0 && i + 1 < argc)
+		{
+			recordPath = args[++i];
+			continue;
+		}
+		
+		GameBoy gameboy;
+		
+		if (!gameboy.LoadROM(args[i]))
+		{
+			printf("Could not load %s, skipping\n", args[i]);
+			continue;
+		}
+		
+		FrameHashLog hashlog;
+		
+		if (hashlogDir)
+		{
+			const char* name = strrchr(args[i], '/');
+			std::string path = std::string(hashlogDir) + "/" + ((name)? name + 1 : args[i]) + ".hashlog";
+			
+			if (!hashlog.Open(path.c_str(), gameboy.GetROMHash()))
+			{
+				printf("Could not write %s, skipping\n", path.c_str());
+				continue;
+			}
+			
+			gameboy.SetFrameHashSink(&hashlog);
+		}
+		
+		Capture capture;
+		capture.SetBlocking(true);
+		
+		if (captureDir)
+		{
+			const char* name = strrchr(args[i], '/');
+			std::string path = std::string(captureDir) + "/" + ((name)? name + 1 : args[i]) + ".bgbc";
+			
+			if (!capture.Open(path.c_str(), gameboy.GetROMHash()))
+			{
+				printf("Could not write %s, skipping\n", path.c_str());
+				continue;
+			}
+			
+			gameboy.SetAudioSink(&capture);
+		}
+		
+		Movie movie;
+		int movieFrames = frames;
+		
+		if (moviePath)
+		{
+			if (!movie.Load(moviePath) || !movie.Play(&gameboy))
+			{
+				printf("Could not play %s on %s, skipping\n", moviePath, args[i]);
+				continue;
+			}
+			
+			movieFrames = movie.GetFrameCount();
+		}
+		else if (recordPath && !movie.Record(&gameboy))
+		{
+			printf("Could not record %s on %s, skipping\n", recordPath, args[i]);
+			continue;
+		}
+		
+		for (int frame = 0; frame < movieFrames; frame++)
+		{
+			uint8_t mask = (moviePath)? movie.GetInput(frame) : GetScriptedInput(frame);
+			
+			if (recordPath)
+				movie.AddFrame(mask);
+			
+			gameboy.SetInput(mask);
+			gameboy.RunFrame();
+			
+			if (captureDir)
+				capture.AddFrame(gameboy.GetFramebuffer());
+		}
+		
+		gameboy.SetAudioSink(NULL);
+		
+		if (captureDir && !capture.Close())
+			printf("Could not write the capture of %s\n", args[i]);
+		
+		if (recordPath && !moviePath && !movie.Save(recordPath))
+			printf("Could not write %s\n", recordPath);
+		
+		printf("%s: %d frames\n", args[i], movieFrames);
+		played++;
+	}
+	
+	return (played > 0)? 0 : 1;
+}
\ No newline at end of file
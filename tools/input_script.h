@@ -0,0 +1,32 @@
+#ifndef __INPUT_SCRIPT__
+#define __INPUT_SCRIPT__
+
+#include "joypad.h"
+
+/*
+ * Fixed input loop for headless runs (gets through menus into gameplay).
+ */
+
+// Buttons held for each half second
+const uint8_t INPUT_SCRIPT[] =
+{
+	0,
+	BUTTON_START,
+	0,
+	BUTTON_A,
+	BUTTON_RIGHT,
+	BUTTON_RIGHT | BUTTON_A,
+	BUTTON_LEFT,
+	BUTTON_UP,
+	BUTTON_DOWN | BUTTON_B,
+	BUTTON_START,
+};
+
+const int INPUT_FRAMES = 30;
+
+inline uint8_t GetScriptedInput(int frame)
+{
+	return INPUT_SCRIPT[(frame / INPUT_FRAMES) % sizeof(INPUT_SCRIPT)];
+}
+
+#endif
\ No newline at end of file
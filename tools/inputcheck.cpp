@@ -0,0 +1,102 @@
+#include "input_queue.h"
+#include "joypad.h"
+#include <stdio.h>
+
+/*
+ * Checks the input queue (run by ctest).
+ * inputcheck
+ * Taps that are pressed and released between two polls have to be kept,
+ * a release that is held back must not hold up other buttons, and
+ * events that don't fit in a full queue can't leave a button stuck.
+ */
+
+int failures = 0;
+
+void Expect(const char* name, uint8_t mask, uint8_t expected)
+{
+	if (mask != expected)
+	{
+		printf("FAILED: %s: buttons 0x%02X, expected 0x%02X\n", name, mask, expected);
+		failures++;
+	}
+}
+
+int main(int argc, char* args[])
+{
+	// A tap between two polls is seen, its release waits until A isn't latched
+	InputQueue queue;
+	uint8_t mask = 0;
+	
+	queue.Push(BUTTON_A, true);
+	queue.Push(BUTTON_A, false);
+	queue.Apply(mask, 0);
+	Expect("tap", mask, BUTTON_A);
+	
+	queue.Apply(mask, BUTTON_A);
+	Expect("tap still latched", mask, BUTTON_A);
+	
+	queue.Apply(mask, 0);
+	Expect("tap released", mask, 0);
+	
+	// Buttons queued behind a held back release
+	InputQueue behind;
+	mask = 0;
+	
+	behind.Push(BUTTON_A, true);
+	behind.Push(BUTTON_A, false);
+	behind.Push(BUTTON_RIGHT, true);
+	behind.Apply(mask, 0);
+	Expect("press behind a tap", mask, BUTTON_A | BUTTON_RIGHT);
+	
+	// The next frame, A's release is still held back
+	behind.Push(BUTTON_RIGHT, false);
+	behind.Push(BUTTON_B, true);
+	behind.Apply(mask, BUTTON_A);
+	Expect("events behind a held back release", mask, BUTTON_A | BUTTON_B);
+	
+	behind.Apply(mask, 0);
+	Expect("held back release", mask, BUTTON_B);
+	
+	// Pressed again before the held back release was applied
+	InputQueue again;
+	mask = 0;
+	
+	again.Push(BUTTON_START, true);
+	again.Push(BUTTON_START, false);
+	again.Apply(mask, 0);
+	again.Push(BUTTON_START, true);
+	again.Apply(mask, BUTTON_START);
+	again.Apply(mask, 0);
+	Expect("pressed again", mask, BUTTON_START);
+	
+	// The game stops polling until the queue is full, A's release doesn't fit
+	InputQueue full;
+	mask = 0;
+	
+	for (int i = 0; i < 127; i++)
+	{
+		full.Push(BUTTON_B, true);
+		full.Push(BUTTON_B, false);
+	}
+	
+	full.Push(BUTTON_B, true);
+	full.Push(BUTTON_A, true);
+	full.Push(BUTTON_A, false);
+	full.Push(BUTTON_DOWN, true);
+	full.Apply(mask, 0);
+	Expect("full queue", mask, BUTTON_A | BUTTON_B | BUTTON_DOWN);
+	
+	full.Apply(mask, 0);
+	Expect("full queue caught up", mask, BUTTON_B | BUTTON_DOWN);
+	
+	// It goes back to queueing events once it has caught up
+	full.Push(BUTTON_B, false);
+	full.Apply(mask, 0);
+	Expect("after a full queue", mask, BUTTON_DOWN);
+	
+	if (failures)
+		return 1;
+	
+	printf("Passed\n");
+	return 0;
+}
\ No newline at end of file
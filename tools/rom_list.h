@@ -0,0 +1,46 @@
+#ifndef __ROM_LIST__
+#define __ROM_LIST__
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+
+inline bool IsROM(const std::string& name)
+{
+	size_t dot = name.rfind('.');
+	
+	if (dot == std::string::npos)
+		return false;
+	
+	std::string ext = name.substr(dot);
+	return ext == ".gb" || ext == ".gbc";
+}
+
+// Adds a ROM, or every ROM in a directory (sorted)
+inline void AddROMs(const char* path, std::vector<std::string>& roms)
+{
+	DIR* dir = opendir(path);
+	
+	if (!dir)
+	{
+		roms.push_back(path);
+		return;
+	}
+	
+	std::vector<std::string> found;
+	struct dirent* entry;
+	
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if (IsROM(entry->d_name))
+			found.push_back(std::string(path) + "/" + entry->d_name);
+	}
+	
+	closedir(dir);
+	
+	std::sort(found.begin(), found.end());
+	roms.insert(roms.end(), found.begin(), found.end());
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "gameboy.h"
+#include "input_script.h"
+#include "rom_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * Savestate round trips (run by ctest on roms/).
+ * statecheck [-frames N] [-threaded] rom|dir...
+ * Plays N frames of the scripted input and saves, plays N more keeping
+ * every frame hash, then loads the state (back into the same GameBoy,
+ * into a new one, and compressed) and plays them again. Every frame has
+ * to hash the same, with the same frame number. Exit code is the number
+ * of ROMs that didn't.
+ */
+
+const int DEFAULT_FRAMES = 300;
+
+class HashList : public FrameHashSink
+{
+	public:
+		std::vector<FrameHash> hashes;
+		
+		void OnFrameHash(const FrameHash& hash) override
+		{
+			hashes.push_back(hash);
+		}
+};
+
+// Plays frames from start, returns the first that hashes differently (-1 = none)
+int Replay(GameBoy& gameboy, HashList& log, int start, int frames, const std::vector<FrameHash>& expected)
+{
+	log.hashes.clear();
+	
+	for (int i = 0; i < frames; i++)
+	{
+		gameboy.SetInput(GetScriptedInput(start + i));
+		gameboy.RunFrame();
+	}
+	
+	for (int i = 0; i < frames; i++)
+	{
+		if (i >= (int)log.hashes.size() || log.hashes[i].frame != expected[i].frame ||
+			log.hashes[i].screen != expected[i].screen || log.hashes[i].ram != expected[i].ram)
+			return start + i;
+	}
+	
+	return -1;
+}
+
+bool Check(const std::string& rom, int frames, bool threaded)
+{
+	GameBoy gameboy;
+	HashList log;
+	
+	if (!gameboy.LoadROM(rom.c_str()))
+	{
+		printf("ERROR   %s: could not load\n", rom.c_str());
+		return false;
+	}
+	
+	gameboy.SetThreadedRendering(threaded);
+	gameboy.SetFrameHashSink(&log);
+	
+	for (int i = 0; i < frames; i++)
+	{
+		gameboy.SetInput(GetScriptedInput(i));
+		gameboy.RunFrame();
+	}
+	
+	std::vector<uint8_t> state(gameboy.GetStateSize());
+	std::vector<uint8_t> packed(gameboy.GetStateSize());
+	size_t size = gameboy.SaveState(&state[0], state.size());
+	size_t packedSize = gameboy.SaveState(&packed[0], packed.size(), true);
+	
+	if (!size || !packedSize)
+	{
+		printf("FAIL    %s: could not save\n", rom.c_str());
+		return false;
+	}
+	
+	log.hashes.clear();
+	
+	for (int i = 0; i < frames; i++)
+	{
+		gameboy.SetInput(GetScriptedInput(frames + i));
+		gameboy.RunFrame();
+	}
+	
+	std::vector<FrameHash> expected = log.hashes;
+	
+	// Back into the same one, into a new one, compressed
+	GameBoy fresh;
+	HashList freshLog;
+	fresh.LoadROM(rom.c_str());
+	fresh.SetThreadedRendering(threaded);
+	fresh.SetFrameHashSink(&freshLog);
+	
+	const char* names[3] = { "reload", "new instance", "compressed" };
+	GameBoy* targets[3] = { &gameboy, &fresh, &gameboy };
+	HashList* logs[3] = { &log, &freshLog, &log };
+	const uint8_t* states[3] = { &state[0], &state[0], &packed[0] };
+	size_t sizes[3] = { size, size, packedSize };
+	
+	for (int i = 0; i < 3; i++)
+	{
+		if (!targets[i]->LoadState(states[i], sizes[i]))
+		{
+			printf("FAIL    %s: %s: could not load\n", rom.c_str(), names[i]);
+			return false;
+		}
+		
+		int frame = Replay(*targets[i], *logs[i], frames, frames, expected);
+		
+		if (frame >= 0)
+		{
+			printf("FAIL    %s: %s: frame %d hashes differently\n", rom.c_str(), names[i], frame);
+			return false;
+		}
+	}
+	
+	printf("PASS    %s (%zu bytes, %zu compressed)\n", rom.c_str(), size, packedSize);
+	return true;
+}
+
+int main(int argc, char* args[])
+{
+	int frames = DEFAULT_FRAMES;
+	bool threaded = false;
+	std::vector<std::string> roms;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -frames N : frames before the save, and after it
+		if (strcmp(args[i], "-frames") == 0 && i + 1 < argc)
+			frames = atoi(args[++i]);
+		// -threaded : draw on the render thread
+		else if (strcmp(args[i], "-threaded") == 0)
+			threaded = true;
+		else
+			AddROMs(args[i], roms);
+	}
+	
+	if (roms.empty() || frames < 1)
+	{
+		printf("Usage: %s [-frames N] [-threaded] rom|dir...\n", args[0]);
+		return 1;
+	}
+	
+	int failed = 0;
+	
+	for (size_t i = 0; i < roms.size(); i++)
+	{
+		if (!Check(roms[i], frames, threaded))
+			failed++;
+	}
+	
+	return failed;
+}
\ No newline at end of file
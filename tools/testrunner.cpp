@@ -0,0 +1,135 @@
+#include "gameboy.h"
+#include "rom_list.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+ * Runs blargg test ROMs headlessly and checks what they print over serial.
+ * testrunner [-cycles N] [-v] rom|dir...
+ * A ROM passes when it prints "Passed", fails on "Failed" or when it
+ * runs out of cycles. Exit code is the number of ROMs that didn't pass.
+ */
+
+// Default budget: 2 emulated minutes
+const uint64_t DEFAULT_CYCLES = 4194304ULL * 120;
+// Keep running a bit after "Failed" to get the details
+const int FAIL_GRACE_CYCLES = 4194304;
+// Check the output every frame
+const int STEP_CYCLES = 70224;
+
+// Collects everything sent over the link cable
+class SerialLog : public SerialSink
+{
+	public:
+		std::string text;
+		
+		uint8_t OnSerialByte(uint8_t data) override
+		{
+			text += (char)data;
+			return 0xFF;
+		}
+};
+
+enum Outcome
+{
+	OUTCOME_PASSED,
+	OUTCOME_FAILED,
+	OUTCOME_TIMEOUT,
+	OUTCOME_LOAD_ERROR,
+};
+
+Outcome Run(const std::string& rom, uint64_t budget, std::string& output, uint64_t& cycles)
+{
+	GameBoy gameboy;
+	SerialLog log;
+	
+	gameboy.SetSerialSink(&log);
+	cycles = 0;
+	
+	if (!gameboy.LoadROM(rom.c_str()))
+		return OUTCOME_LOAD_ERROR;
+	
+	// Nothing is drawn, only the serial output matters
+	gameboy.SetFrameSkip(0);
+	
+	Outcome outcome = OUTCOME_TIMEOUT;
+	
+	while (cycles < budget)
+	{
+		cycles += gameboy.RunCycles(STEP_CYCLES);
+		
+		if (log.text.find("Passed") != std::string::npos)
+		{
+			outcome = OUTCOME_PASSED;
+			break;
+		}
+		
+		if (log.text.find("Failed") != std::string::npos)
+		{
+			cycles += gameboy.RunCycles(FAIL_GRACE_CYCLES);
+			outcome = OUTCOME_FAILED;
+			break;
+		}
+	}
+	
+	output = log.text;
+	return outcome;
+}
+
+int main(int argc, char* args[])
+{
+	uint64_t budget = DEFAULT_CYCLES;
+	bool verbose = false;
+	std::vector<std::string> roms;
+	
+	for (int i = 1; i < argc; i++)
+	{
+		// -cycles N : CPU cycle budget per ROM
+		if (strcmp(args[i], "-cycles") == 0 && i + 1 < argc)
+			budget = strtoull(args[++i], NULL, 10);
+		// -v : print the serial output of passing ROMs too
+		else if (strcmp(args[i], "-v") == 0)
+			verbose = true;
+		else
+			AddROMs(args[i], roms);
+	}
+	
+	if (roms.empty())
+	{
+		printf("Usage: %s [-cycles N] [-v] rom|dir...\n", args[0]);
+		return 1;
+	}
+	
+	int failed = 0;
+	
+	for (size_t i = 0; i < roms.size(); i++)
+	{
+		std::string output;
+		uint64_t cycles;
+		
+		Outcome outcome = Run(roms[i], budget, output, cycles);
+		
+		switch (outcome)
+		{
+			case OUTCOME_PASSED: printf("PASS    "); break;
+			case OUTCOME_FAILED: printf("FAIL    "); break;
+			case OUTCOME_TIMEOUT: printf("TIMEOUT "); break;
+			case OUTCOME_LOAD_ERROR: printf("ERROR   "); break;
+		}
+		
+		printf("%s (%llu cycles)\n", roms[i].c_str(), (unsigned long long)cycles);
+		
+		if (outcome != OUTCOME_PASSED)
+			failed++;
+		
+		if (outcome != OUTCOME_PASSED || verbose)
+			printf("%s\n", output.c_str());
+	}
+	
+	printf("%d/%d passed\n", (int)roms.size() - failed, (int)roms.size());
+	
+	return failed;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#ifndef __THREAD_POOL__
+#define __THREAD_POOL__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <functional>
+
+/*
+ * Work-stealing thread pool.
+ * Every worker has its own queue: it takes its newest task first and,
+ * when empty, steals the oldest task from another worker.
+ * Tasks are whole emulator runs (milliseconds to minutes), so each
+ * queue is a mutex + deque rather than a lock-free deque.
+ */
+class ThreadPool
+{
+	typedef std::function<void(int worker)> Task;
+	
+	// One per worker (padded so workers don't share a cache line)
+	struct Queue
+	{
+		char padding0[64];
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		char padding1[64];
+	};
+	
+	public:
+		ThreadPool(int threads)
+		{
+			if (threads < 1)
+				threads = 1;
+			
+			pending = 0;
+			queued = 0;
+			stopping = false;
+			next = 0;
+			
+			for (int i = 0; i < threads; i++)
+				queues.push_back(new Queue());
+			
+			for (int i = 0; i < threads; i++)
+				workers.push_back(std::thread(&ThreadPool::Run, this, i));
+		}
+		
+		~ThreadPool()
+		{
+			Wait();
+			
+			{
+				std::lock_guard<std::mutex> lock(idleMutex);
+				stopping = true;
+			}
+			
+			idle.notify_all();
+			
+			for (size_t i = 0; i < workers.size(); i++)
+				workers[i].join();
+			
+			for (size_t i = 0; i < queues.size(); i++)
+				delete queues[i];
+		}
+		
+		int GetThreadCount()
+		{
+			return (int)workers.size();
+		}
+		
+		// Queues a task (spread round robin, idle workers steal the rest)
+		void Submit(const Task& task)
+		{
+			Queue* queue = queues[next++ % queues.size()];
+			
+			// Count it first, so it can't finish before it's counted
+			{
+				std::lock_guard<std::mutex> lock(idleMutex);
+				pending++;
+			}
+			
+			{
+				std::lock_guard<std::mutex> lock(queue->mutex);
+				queue->tasks.push_back(task);
+			}
+			
+			// Counted under the lock idle workers check it with, so none misses it
+			{
+				std::lock_guard<std::mutex> lock(idleMutex);
+				queued++;
+			}
+			
+			idle.notify_one();
+		}
+		
+		// Waits until every submitted task is done
+		void Wait()
+		{
+			std::unique_lock<std::mutex> lock(idleMutex);
+			done.wait(lock, [this]() { return pending == 0; });
+		}
+		
+	private:
+		std::vector<Queue*> queues;
+		std::vector<std::thread> workers;
+		size_t next;
+		
+		// Tasks queued or running
+		int pending;
+		// Tasks not taken yet (can dip below 0 while one is taken before it's counted)
+		int queued;
+		bool stopping;
+		std::mutex idleMutex;
+		std::condition_variable idle;
+		std::condition_variable done;
+		
+		// Own queue first (newest), then steal (oldest) from the others
+		bool GetTask(int index, Task& task)
+		{
+			for (size_t i = 0; i < queues.size(); i++)
+			{
+				Queue* queue = queues[(index + i) % queues.size()];
+				std::lock_guard<std::mutex> lock(queue->mutex);
+				
+				if (queue->tasks.empty())
+					continue;
+				
+				if (i == 0)
+				{
+					task = queue->tasks.back();
+					queue->tasks.pop_back();
+				}
+				else
+				{
+					task = queue->tasks.front();
+					queue->tasks.pop_front();
+				}
+				
+				return true;
+			}
+			
+			return false;
+		}
+		
+		void Run(int index)
+		{
+			while (true)
+			{
+				Task task;
+				
+				if (GetTask(index, task))
+				{
+					{
+						std::lock_guard<std::mutex> lock(idleMutex);
+						queued--;
+					}
+					
+					task(index);
+					
+					std::lock_guard<std::mutex> lock(idleMutex);
+					
+					if (--pending == 0)
+						done.notify_all();
+					
+					continue;
+				}
+				
+				// Nothing to do, sleep until something is submitted
+				std::unique_lock<std::mutex> lock(idleMutex);
+				idle.wait(lock, [this]() { return queued > 0 || stopping; });
+				
+				if (stopping && queued <= 0)
+					return;
+			}
+		}
+};
+
+#endif
\ No newline at end of file